@@ -205,13 +205,13 @@ void KGoldrunner::setupActions()
     saveGame->setText (i18nc ("@action", "&Save Game…"));
     KActionCollection::setDefaultShortcut(saveGame, Qt::Key_S); // Alternate key.
 
-    // The name of the solution-file is 'sol_<prefix>.txt', where <prefix> is
+    // The name of the solution-file is 'sol_<prefix>.kgrec', where <prefix> is
     // the unique prefix belonging to the game involved (eg. plws, tute, etc.).
     a        = gameAction (QStringLiteral("save_solution"), SAVE_SOLUTION,
                            i18nc ("@action", "Save a Solution…"),
                            i18nc ("@info:tooltip", "Save a solution"),
                            i18nc ("@info:whatsthis", "Saves a solution for a level into a file "
-                                 "called 'sol_&lt;prefix&gt;.txt' in your "
+                                 "called 'sol_&lt;prefix&gt;.kgrec' in your "
 				 "user's data directory."),
                            {Qt::ShiftModifier | Qt::Key_S});
 
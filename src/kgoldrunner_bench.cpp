@@ -0,0 +1,401 @@
+/*
+    SPDX-FileCopyrightText: 2026 The KGoldrunner Developers
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+/*
+ * kgoldrunner_bench: a command-line tool that times the parts of KGoldrunner
+ * that run most often, on all the levels of the installed games, so that the
+ * speed of different builds can be compared before and after a change.
+ *
+ * Each benchmark is run over and over until it has taken at least the minimum
+ * time (after one run to warm up) and its mean time per operation is reported.
+ * The output has a header line and then one line per benchmark, with
+ * tab-separated fields: benchmark name, parameter ("-" if none), number of
+ * operations timed and nanoseconds per operation.  The benchmarks are:
+ *
+ *   calculateAccess     KGrLevelGrid::calculateAccess(), per level.
+ *   changeCellAt        KGrLevelGrid::changeCellAt(), per change, digging and
+ *                       refilling every brick of each level.
+ *   findBestWay         findBestWay() of each KGrRuleBook subclass (parameter
+ *                       T, K or S), per call, from each enemy to the hero.
+ *   tick                KGrLevelPlayer ticks, per tick, on the levels with a
+ *                       given number of enemies (parameter), with the hero
+ *                       moving at random and each level restarted as it ends.
+ *   fetchGameListData   KGrGameIO::fetchGameListData(), per call.
+ *   fetchLevelData      KGrGameIO::fetchLevelData(), per level.
+ *   thumbNail           KGrThumbNail::paintEvent(), per level, drawn into an
+ *                       image.
+ */
+
+#include "kgrglobals.h"
+#include "kgrgameio.h"
+#include "kgrlevelgrid.h"
+#include "kgrlevelobserver.h"
+#include "kgrlevelplayer.h"
+#include "kgrrandom.h"
+#include "kgrrulebook.h"
+#include "kgrselector.h"
+#include "kgrsolver.h"
+
+#include <QApplication>
+#include <QCommandLineParser>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QImage>
+#include <QLabel>
+#include <QList>
+#include <QMap>
+#include <QStandardPaths>
+#include <QTextStream>
+
+#include <functional>
+
+/// One level of an installed game, as read by KGrGameIO.
+typedef struct {
+    const KGrGameData * game;
+    int                 levelNo;
+    KGrLevelData        data;
+    int                 enemies;	// The number of enemies at the start.
+} BenchLevel;
+
+/**
+ * Run one round of a benchmark after another until the minimum time has gone
+ * by, then print the mean time per operation.  Each round returns the number
+ * of operations it did.
+ */
+static void measure (QTextStream & out, const QString & name,
+                     const QString & param, const qint64 minTime,
+                     const std::function<qint64()> & round)
+{
+    round();				// Warm up the caches.
+
+    QElapsedTimer t;
+    qint64        ops = 0;
+    t.start();
+    do {
+        ops += round();
+    } while ((t.nsecsElapsed() < minTime) && (ops > 0));
+
+    double nsPerOp = (ops > 0) ? (double (t.nsecsElapsed()) / ops) : 0.0;
+    out << name << '\t' << param << '\t' << ops << '\t'
+        << QString::number (nsPerOp, 'f', 1) << '\n';
+    out.flush();
+}
+
+// Make a grid of a level, with the hero and enemies taken out of it as
+// KGrLevelPlayer::init() does, and their cells (i + j * width) listed.
+static KGrLevelGrid * makeGrid (const BenchLevel & level, int & hero,
+                                QList<int> & enemies)
+{
+    KGrRecording layout;
+    layout.width  = level.data.width;
+    layout.height = level.data.height;
+    layout.layout = level.data.layout;
+    hero          = -1;
+    enemies.clear();
+
+    const int gridWidth = layout.width + 2 * ConcreteWall;
+    for (int n = 0; n < layout.layout.size(); n++) {
+        char type     = layout.layout.at (n);
+        int  position = (n % layout.width + ConcreteWall) +
+                        (n / layout.width + ConcreteWall) * gridWidth;
+        if (type == HERO) {
+            hero = position;
+            layout.layout [n] = FREE;
+        }
+        else if (type == ENEMY) {
+            enemies.append (position);
+            layout.layout [n] = FREE;
+        }
+    }
+    return new KGrLevelGrid (nullptr, &layout);
+}
+
+static KGrRuleBook * makeRules (const char rules)
+{
+    switch (rules) {
+    case TraditionalRules:
+        return new KGrTraditionalRules (nullptr);
+    case ScavengerRules:
+        return new KGrScavengerRules (nullptr);
+    default:
+        return new KGrKGoldrunnerRules (nullptr);
+    }
+}
+
+int main (int argc, char ** argv)
+{
+    // The thumbnails are drawn into images, so no display is needed.
+    if (qEnvironmentVariableIsEmpty ("QT_QPA_PLATFORM")) {
+        qputenv ("QT_QPA_PLATFORM", "offscreen");
+    }
+    QApplication app (argc, argv);
+    QApplication::setApplicationName (QStringLiteral("kgoldrunner"));
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription (QStringLiteral(
+        "Time the most-used parts of KGoldrunner on the levels of its games."));
+    parser.addHelpOption();
+    parser.addOption (QCommandLineOption (
+        QStringLiteral("min-time"),
+        QStringLiteral("Run each benchmark for at least this many "
+                       "milliseconds (default: 500)."),
+        QStringLiteral("ms"), QStringLiteral("500")));
+    parser.addOption (QCommandLineOption (
+        QStringList {QStringLiteral("b"), QStringLiteral("bench")},
+        QStringLiteral("Run only the benchmarks whose names contain this."),
+        QStringLiteral("name")));
+    parser.addOption (QCommandLineOption (
+        QStringList {QStringLiteral("g"), QStringLiteral("game")},
+        QStringLiteral("Use only the game with this prefix (e.g. plws)."),
+        QStringLiteral("prefix")));
+    parser.addOption (QCommandLineOption (
+        QStringLiteral("ticks"),
+        QStringLiteral("Ticks to play in each level, per round of the tick "
+                       "benchmark (default: 200)."),
+        QStringLiteral("n"), QStringLiteral("200")));
+    parser.addPositionalArgument (QStringLiteral("dir"),
+        QStringLiteral("Folder containing the game_* files (default: the "
+                       "system games)."),
+        QStringLiteral("[dir]"));
+    parser.process (app);
+
+    QString dir;
+    if (parser.positionalArguments().isEmpty()) {
+        dir = QStandardPaths::locate (QStandardPaths::AppDataLocation,
+                                      QStringLiteral("system/"),
+                                      QStandardPaths::LocateDirectory);
+        if (dir.isEmpty()) {
+            QTextStream (stderr) << "Cannot find the system games folder.\n";
+            return 2;
+        }
+    }
+    else {
+        dir = parser.positionalArguments().first();
+    }
+    dir = QDir (dir).absolutePath() + QLatin1Char('/');
+
+    const qint64  minTime  = 1000000 *
+                   parser.value (QStringLiteral("min-time")).toLongLong();
+    const QString onlyGame = parser.value (QStringLiteral("game"));
+    const QString onlyName = parser.value (QStringLiteral("bench"));
+    const int     ticks    = parser.value (QStringLiteral("ticks")).toInt();
+    auto selected = [&onlyName] (const QString & name) {
+                        return onlyName.isEmpty() || name.contains (onlyName);
+                    };
+
+    KGrGameIO            io (nullptr);
+    QList<KGrGameData *> gameList;
+    QString              gamePath;
+    if (io.fetchGameListData (SYSTEM, dir, gameList, gamePath) != OK) {
+        QTextStream (stderr) << "Cannot read the games in " << dir << "\n";
+        return 2;
+    }
+
+    QList<BenchLevel> levels;
+    for (KGrGameData * game : std::as_const(gameList)) {
+        if ((! onlyGame.isEmpty()) && (game->prefix != onlyGame)) {
+            continue;
+        }
+        for (int levelNo = 1; levelNo <= game->nLevels; levelNo++) {
+            BenchLevel level;
+            QString    filePath;
+            level.game    = game;
+            level.levelNo = levelNo;
+            level.data.digWhileFalling = game->digWhileFalling;
+            if (io.fetchLevelData (dir, game->prefix, levelNo,
+                                   level.data, filePath) != OK) {
+                continue;
+            }
+            level.enemies = level.data.layout.count (ENEMY);
+            levels.append (level);
+        }
+    }
+    if (levels.isEmpty()) {
+        QTextStream (stderr) << "No levels found in " << dir << "\n";
+        return 2;
+    }
+
+    QTextStream out (stdout);
+    out << "benchmark\tparameter\toperations\tns_per_op\n";
+    const QString none = QStringLiteral("-");
+
+    // Grids of all the levels, with the hero's and enemies' cells.
+    QList<KGrLevelGrid *> grids;
+    QList<int>            heroes;
+    QList<QList<int>>     enemyLists;
+    for (const BenchLevel & level : std::as_const(levels)) {
+        int        hero;
+        QList<int> enemies;
+        grids.append (makeGrid (level, hero, enemies));
+        grids.last()->calculateAccess (false);
+        heroes.append (hero);
+        enemyLists.append (enemies);
+    }
+
+    if (selected (QStringLiteral("calculateAccess"))) {
+        measure (out, QStringLiteral("calculateAccess"), none, minTime, [&] () {
+            for (KGrLevelGrid * grid : std::as_const(grids)) {
+                grid->calculateAccess (false);
+            }
+            return (qint64) grids.count();
+        });
+    }
+
+    if (selected (QStringLiteral("changeCellAt"))) {
+        measure (out, QStringLiteral("changeCellAt"), none, minTime, [&] () {
+            qint64 changes = 0;
+            for (KGrLevelGrid * grid : std::as_const(grids)) {
+                const int w = grid->levelWidth();
+                const int h = grid->levelHeight();
+                for (int j = 1; j <= h; j++) {
+                    for (int i = 1; i <= w; i++) {
+                        if (grid->cellType (i, j) == BRICK) {
+                            grid->changeCellAt (i, j, HOLE);
+                            grid->changeCellAt (i, j, BRICK);
+                            changes += 2;
+                        }
+                    }
+                }
+                grid->takeChanges();
+            }
+            return changes;
+        });
+    }
+
+    const char ruleCodes [3] = {TraditionalRules, KGoldrunnerRules,
+                                ScavengerRules};
+    for (const char code : ruleCodes) {
+        if (! selected (QStringLiteral("findBestWay"))) {
+            break;
+        }
+        QList<KGrRuleBook *> ruleBooks;	// One per level, as in the game.
+        for (int n = 0; n < levels.count(); n++) {
+            ruleBooks.append (makeRules (code));
+        }
+        measure (out, QStringLiteral("findBestWay"),
+                 QString (QLatin1Char(code)), minTime, [&] () {
+            qint64 calls = 0;
+            for (int n = 0; n < levels.count(); n++) {
+                KGrLevelGrid * grid = grids.at (n);
+                const int      w    = grid->gridWidth();
+                const int      hero = heroes.at (n);
+                if (hero < 0) {
+                    continue;
+                }
+                for (const int enemy : std::as_const(enemyLists.at (n))) {
+                    ruleBooks.at (n)->findBestWay (enemy % w, enemy / w,
+                                                   hero % w, hero / w, grid);
+                    calls++;
+                }
+            }
+            return calls;
+        });
+        qDeleteAll (ruleBooks);
+    }
+    qDeleteAll (grids);
+
+    if (selected (QStringLiteral("tick"))) {
+        // Group the levels by the number of enemies they start with.
+        QMap<int, QList<int>> byEnemies;
+        for (int n = 0; n < levels.count(); n++) {
+            byEnemies [levels.at (n).enemies].append (n);
+        }
+        for (auto it = byEnemies.cbegin(); it != byEnemies.cend(); ++it) {
+            QList<KGrRecording *>             recordings;
+            QList<KGrLevelObserver *>         observers;
+            QList<KGrLevelPlayer *>           players;
+            QList<KGrLevelPlayer::Snapshot>   starts;
+            for (const int n : it.value()) {
+                const BenchLevel & level = levels.at (n);
+                KGrRecording *     rec   = new KGrRecording;
+                KGrLevelObserver * obs   = new KGrLevelObserver;
+                KGrLevelPlayer *   p     = new KGrLevelPlayer (nullptr,
+                                                                   nullptr);
+                KGrSolver::setUpLevel (*rec, *level.game, level.data,
+                                       level.levelNo);
+                p->init (obs, rec, false, false, false);
+                p->setTimeScale (rec->speed);
+                p->prepareToPlay();
+                recordings.append (rec);
+                observers.append (obs);
+                players.append (p);
+                starts.append (p->saveState());
+            }
+            // The hero's keys come from a fixed sequence, so that every run
+            // plays the same ticks.
+            KGrRandom keys (1);
+            measure (out, QStringLiteral("tick"), QString::number (it.key()),
+                     minTime, [&] () {
+                for (int n = 0; n < players.count(); n++) {
+                    KGrLevelPlayer * p = players.at (n);
+                    p->restoreState (starts.at (n));
+                    for (int t = 0; t < ticks; t++) {
+                        Direction key = (Direction) keys.bounded (DIG_LEFT + 1);
+                        if (p->step (key) != NORMAL) {
+                            p->restoreState (starts.at (n));
+                        }
+                    }
+                }
+                return (qint64) players.count() * ticks;
+            });
+            qDeleteAll (players);
+            qDeleteAll (observers);
+            qDeleteAll (recordings);
+        }
+    }
+
+    if (selected (QStringLiteral("fetchGameListData"))) {
+        measure (out, QStringLiteral("fetchGameListData"), none, minTime,
+                 [&] () {
+            QList<KGrGameData *> list;
+            QString              path;
+            io.fetchGameListData (SYSTEM, dir, list, path);
+            qDeleteAll (list);
+            return (qint64) 1;
+        });
+    }
+
+    if (selected (QStringLiteral("fetchLevelData"))) {
+        measure (out, QStringLiteral("fetchLevelData"), none, minTime, [&] () {
+            for (const BenchLevel & level : std::as_const(levels)) {
+                KGrLevelData data;
+                QString      filePath;
+                io.fetchLevelData (dir, level.game->prefix, level.levelNo,
+                                   data, filePath);
+            }
+            return (qint64) levels.count();
+        });
+    }
+
+    if (selected (QStringLiteral("thumbNail"))) {
+        // A thumbnail of each level, of the size in the Select Game dialog
+        // with the smallest cells (see KGrSLDialog::setupWidgets()), so that
+        // only the painting is timed.
+        const int             cellSize = 4;
+        QList<KGrThumbNail *> thumbNails;
+        QLabel                name;
+        QImage                image ((FIELDWIDTH  * cellSize) + 2,
+                                     (FIELDHEIGHT * cellSize) + 2,
+                                     QImage::Format_RGB32);
+        for (const BenchLevel & level : std::as_const(levels)) {
+            KGrThumbNail * thumbNail = new KGrThumbNail;
+            thumbNail->setFixedSize (image.size());
+            thumbNail->setLevelData (dir, level.game->prefix, level.levelNo,
+                                     &name);
+            thumbNails.append (thumbNail);
+        }
+        measure (out, QStringLiteral("thumbNail"), none, minTime, [&] () {
+            for (KGrThumbNail * thumbNail : std::as_const(thumbNails)) {
+                thumbNail->render (&image);
+            }
+            return (qint64) thumbNails.count();
+        });
+        qDeleteAll (thumbNails);
+    }
+
+    qDeleteAll (gameList);
+    return 0;
+}
@@ -0,0 +1,58 @@
+/*
+    SPDX-FileCopyrightText: 2026 The KGoldrunner Developers
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+/*
+ * kgoldrunner_convert: a command-line tool that converts rec_*.txt and
+ * sol_*.txt recording files to the binary format (rec_*.kgrec, sol_*.kgrec).
+ * Each binary file is written alongside its text file, which is left as it is.
+ */
+
+#include "kgrrecordingio.h"
+
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QTextStream>
+
+int main (int argc, char ** argv)
+{
+    QCoreApplication app (argc, argv);
+    QCoreApplication::setApplicationName (QStringLiteral("kgoldrunner"));
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription (QStringLiteral(
+        "Convert KGoldrunner recording files from text to the binary format."));
+    parser.addHelpOption();
+    parser.addPositionalArgument (QStringLiteral("files"),
+        QStringLiteral("Text recording files (rec_*.txt or sol_*.txt)."),
+        QStringLiteral("files..."));
+    parser.process (app);
+
+    const QStringList files = parser.positionalArguments();
+    if (files.isEmpty()) {
+        parser.showHelp (2);
+    }
+
+    QTextStream out (stdout);
+    int failed = 0;
+    for (const QString & textPath : files) {
+        if (KGrRecordingIO::isBinary (textPath)) {
+            QTextStream (stderr) << textPath << " is already binary\n";
+            failed++;
+            continue;
+        }
+        QString binaryPath = KGrRecordingIO::binaryName (textPath);
+        int     count      = KGrRecordingIO::convert (textPath, binaryPath);
+        if (count < 0) {
+            QTextStream (stderr) << "Cannot convert " << textPath << " to "
+                                 << binaryPath << "\n";
+            failed++;
+            continue;
+        }
+        out << textPath << " -> " << binaryPath << ": " << count
+            << " levels\n";
+    }
+    return (failed > 0) ? 1 : 0;
+}
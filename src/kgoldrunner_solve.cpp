@@ -0,0 +1,169 @@
+/*
+    SPDX-FileCopyrightText: 2026 The KGoldrunner Developers
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+/*
+ * kgoldrunner_solve: a command-line tool that searches for a way to win each
+ * level of the KGoldrunner games, using KGrSolver, and saves the solutions it
+ * finds in sol_<prefix>.kgrec files, which KGoldrunner can show with "Show a
+ * Solution" and kgoldrunner_verify can check.
+ *
+ * The levels are solved one at a time, each on a pool of worker threads.  The
+ * output has one line per level, with tab-separated fields: game prefix, level
+ * number, result ("solved" or "unsolved"), number of ticks in the solution
+ * ("-" if none), number of states searched and states searched per second.
+ * The exit status is 1 if any level is not solved.
+ */
+
+#include "kgrglobals.h"
+#include "kgrgameio.h"
+#include "kgrrecordingio.h"
+#include "kgrsolver.h"
+
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QDir>
+#include <QList>
+#include <QStandardPaths>
+#include <QTextStream>
+
+int main (int argc, char ** argv)
+{
+    QCoreApplication app (argc, argv);
+    QCoreApplication::setApplicationName (QStringLiteral("kgoldrunner"));
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription (QStringLiteral(
+        "Search for solutions to KGoldrunner levels and save them on "
+        "sol_* files."));
+    parser.addHelpOption();
+    parser.addOption (QCommandLineOption (
+        QStringList {QStringLiteral("j"), QStringLiteral("jobs")},
+        QStringLiteral("Number of worker threads (default: one per core)."),
+        QStringLiteral("n"), QStringLiteral("0")));
+    parser.addOption (QCommandLineOption (
+        QStringLiteral("max-states"),
+        QStringLiteral("Give up on a level after searching this many states."),
+        QStringLiteral("n"), QStringLiteral("1000000")));
+    parser.addOption (QCommandLineOption (
+        QStringLiteral("time-limit"),
+        QStringLiteral("Give up on a level after this many seconds."),
+        QStringLiteral("s"), QStringLiteral("60")));
+    parser.addOption (QCommandLineOption (
+        QStringList {QStringLiteral("g"), QStringLiteral("game")},
+        QStringLiteral("Solve only the game with this prefix (e.g. plws)."),
+        QStringLiteral("prefix")));
+    parser.addOption (QCommandLineOption (
+        QStringList {QStringLiteral("l"), QStringLiteral("level")},
+        QStringLiteral("Solve only this level of each game."),
+        QStringLiteral("n")));
+    parser.addOption (QCommandLineOption (
+        QStringList {QStringLiteral("o"), QStringLiteral("output")},
+        QStringLiteral("Folder for the sol_* files (default: the current "
+                       "folder)."),
+        QStringLiteral("dir"), QStringLiteral(".")));
+    parser.addPositionalArgument (QStringLiteral("dir"),
+        QStringLiteral("Folder containing the game_* files (default: the "
+                       "system games)."),
+        QStringLiteral("[dir]"));
+    parser.process (app);
+
+    QString dir;
+    if (parser.positionalArguments().isEmpty()) {
+        dir = QStandardPaths::locate (QStandardPaths::AppDataLocation,
+                                      QStringLiteral("system/"),
+                                      QStandardPaths::LocateDirectory);
+        if (dir.isEmpty()) {
+            QTextStream (stderr) << "Cannot find the system games folder.\n";
+            return 2;
+        }
+    }
+    else {
+        dir = parser.positionalArguments().first();
+    }
+    dir = QDir (dir).absolutePath() + QLatin1Char('/');
+    QDir outDir (parser.value (QStringLiteral("output")));
+
+    KGrGameIO            io (nullptr);
+    QList<KGrGameData *> gameList;
+    QString              gamePath;
+    if (io.fetchGameListData (SYSTEM, dir, gameList, gamePath) != OK) {
+        QTextStream (stderr) << "Cannot read the games in " << dir << "\n";
+        return 2;
+    }
+
+    const QString onlyGame  = parser.value (QStringLiteral("game"));
+    const int     onlyLevel = parser.value (QStringLiteral("level")).toInt();
+    const int     threads   = parser.value (QStringLiteral("jobs")).toInt();
+    const qint64  maxStates =
+                  parser.value (QStringLiteral("max-states")).toLongLong();
+    const qint64  timeLimit = 1000 *
+                  parser.value (QStringLiteral("time-limit")).toLongLong();
+
+    QTextStream out (stdout);
+    int solved   = 0;
+    int unsolved = 0;
+    for (const KGrGameData * game : std::as_const(gameList)) {
+        if ((! onlyGame.isEmpty()) && (game->prefix != onlyGame)) {
+            continue;
+        }
+        QString filename = outDir.filePath (QStringLiteral("sol_") +
+                           game->prefix + QStringLiteral(".kgrec"));
+        for (int levelNo = 1; levelNo <= game->nLevels; levelNo++) {
+            if ((onlyLevel > 0) && (levelNo != onlyLevel)) {
+                continue;
+            }
+
+            KGrLevelData levelData;
+            QString      filePath;
+            levelData.digWhileFalling = game->digWhileFalling;
+            if (io.fetchLevelData (dir, game->prefix, levelNo,
+                                   levelData, filePath) != OK) {
+                QTextStream (stderr) << "Cannot read level " << levelNo
+                                     << " of " << game->prefix << "\n";
+                unsolved++;
+                continue;
+            }
+
+            KGrRecording level;
+            KGrRecording solution;
+            KGrSolver::setUpLevel (level, *game, levelData, levelNo);
+            KGrSolver solver (level, threads);
+            solver.setMaxStates (maxStates);
+            solver.setTimeLimit (timeLimit);
+            bool won = solver.solve (solution);
+
+            qint64 ms = qMax (solver.elapsed(), (qint64) 1);
+            out << game->prefix << '\t' << levelNo << '\t'
+                << (won ? "solved" : "unsolved") << '\t';
+            if (won) {
+                out << solver.solutionTicks();
+            }
+            else {
+                out << '-';
+            }
+            out << '\t' << solver.statesSearched() << '\t'
+                << (solver.statesSearched() * 1000 / ms) << '\n';
+            out.flush();
+
+            if (! won) {
+                unsolved++;
+                continue;
+            }
+            solved++;
+            QString groupName = game->prefix +
+                QString::number (levelNo).rightJustified (3, QLatin1Char('0'));
+            if (! KGrRecordingIO::write (filename, groupName, &solution)) {
+                QTextStream (stderr) << "Cannot write " << filename << "\n";
+                return 2;
+            }
+        }
+    }
+
+    QTextStream (stderr) << solved << " levels solved, " << unsolved
+                         << " not solved\n";
+    qDeleteAll (gameList);
+    return (unsolved > 0) ? 1 : 0;
+}
@@ -0,0 +1,305 @@
+/*
+    SPDX-FileCopyrightText: 2026 The KGoldrunner Developers
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+/*
+ * kgoldrunner_verify: a command-line tool that replays every recording in the
+ * rec_* and sol_* files of KGoldrunner and reports how each one ends.  Both
+ * the text (.txt) and binary (.kgrec) formats can be read.
+ *
+ * Each recorded level is replayed by its own KGrLevelPlayer, with its own copy
+ * of the recording, in fixed-step mode (no timer and no graphics), on a pool
+ * of worker threads.  The output has one line per level, with tab-separated
+ * fields: file-name, group (prefix + level), result, final score, number of
+ * ticks and the first tick at which the replay differed from the checksums
+ * stored in the recording ("-" if it did not differ, or the recording has no
+ * checksums).  The exit status is 1 if any level in a solution file (sol_*)
+ * does not end with the hero winning, or any replay differs from its
+ * recording, so the tool can be used as a test.
+ */
+
+#include "kgrglobals.h"
+#include "kgrgameio.h"
+#include "kgrlevelobserver.h"
+#include "kgrlevelplayer.h"
+#include "kgrrecordingio.h"
+
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFileInfo>
+#include <QHash>
+#include <QList>
+#include <QRunnable>
+#include <QStandardPaths>
+#include <QTextStream>
+#include <QThreadPool>
+
+/// The data and the results for one recorded level.
+class KGrVerifyJob
+{
+public:
+    QString        fileName;	///< Name of the rec_* or sol_* file.
+    QString        group;	///< KConfig group (prefix + level number).
+    bool           solution;	///< True if the file is a sol_* file.
+    KGrRecording   recording;	///< The recorded level and moves.
+
+    int            result;	///< NORMAL, WON_LEVEL, DEAD or UNEXPECTED_END.
+    long           score;	///< Score at the end of the level.
+    int            ticks;	///< Number of ticks played.
+    int            diverged;	///< First tick that differed, or -1.
+};
+
+/**
+ * Replays one recorded level in a worker thread.  Nothing is shared with the
+ * other jobs, so the jobs can run in parallel with no locking.
+ */
+class KGrVerifyTask : public QRunnable
+{
+public:
+    KGrVerifyTask (KGrVerifyJob * pJob, const int pMaxTicks)
+        : job (pJob), maxTicks (pMaxTicks) {}
+
+    void run() override
+    {
+        KGrLevelObserver observer;	// No graphics: all calls do nothing.
+        KGrLevelPlayer   player (nullptr, nullptr);	// No random numbers.
+        long             scored = 0;
+
+        QObject::connect (&player, &KGrLevelPlayer::incScore,
+                          [&scored] (const int n) { scored += n; });
+
+        player.init (&observer, &job->recording, true, false, false);
+        player.setTimeScale (job->recording.speed);
+        job->result = player.runFixedStep (maxTicks);
+        job->ticks  = player.tickCount();
+        job->diverged = player.divergentTick();
+
+        // KGrGame adds 1500 for completing a level.
+        job->score  = job->recording.score + scored +
+                      ((job->result == WON_LEVEL) ? 1500 : 0);
+    }
+
+private:
+    KGrVerifyJob * job;
+    int            maxTicks;
+};
+
+static const char * resultName (const int result)
+{
+    switch (result) {
+    case WON_LEVEL:
+        return "won";
+    case DEAD:
+        return "died";
+    case UNEXPECTED_END:
+        return "unexpected-end";
+    default:
+        return "timeout";
+    }
+}
+
+/**
+ * Find the current "dig while falling" setting for a recorded level, as
+ * KGrGame::loadRecording() does when it replays a demo or solution.  Recording
+ * files saved by older versions of KGoldrunner do not contain the setting.
+ */
+static bool digWhileFalling (KGrGameIO & io, const QString & dir,
+                             QHash<QString, KGrGameData *> & games,
+                             const KGrRecording & recording)
+{
+    KGrGameData * game = games.value (recording.prefix, nullptr);
+    if (game == nullptr) {
+        return recording.digWhileFalling;
+    }
+
+    KGrLevelData levelData;
+    QString      filePath;
+    levelData.digWhileFalling = game->digWhileFalling;
+    if (io.fetchLevelData (dir, recording.prefix, recording.level,
+                           levelData, filePath) == OK) {
+        return levelData.digWhileFalling;
+    }
+    return game->digWhileFalling;
+}
+
+/**
+ * Read all the recorded levels in one rec_* or sol_* file, in either format,
+ * and append them to the list of jobs.
+ */
+static bool loadRecordings (KGrGameIO & io, const QString & filePath,
+                            QHash<QString, KGrGameData *> & games,
+                            QList<KGrVerifyJob *> & jobs)
+{
+    QFileInfo           fileInfo (filePath);
+    QString             dir = fileInfo.absolutePath() + QLatin1Char('/');
+    QStringList         groups;
+    QList<KGrRecording> recordings;
+
+    if (! KGrRecordingIO::readFile (filePath, groups, recordings)) {
+        return false;
+    }
+    for (int n = 0; n < groups.count(); n++) {
+        KGrVerifyJob * job = new KGrVerifyJob;
+        job->fileName  = fileInfo.fileName();
+        job->group     = groups.at (n);
+        job->solution  = job->fileName.startsWith (QLatin1String("sol_"));
+        job->recording = recordings.at (n);
+        job->result    = NORMAL;
+        job->score     = 0;
+        job->ticks     = 0;
+        job->diverged  = -1;
+
+        job->recording.digWhileFalling =
+                        digWhileFalling (io, dir, games, job->recording);
+        jobs.append (job);
+    }
+    return true;
+}
+
+int main (int argc, char ** argv)
+{
+    QCoreApplication app (argc, argv);
+    QCoreApplication::setApplicationName (QStringLiteral("kgoldrunner"));
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription (QStringLiteral(
+        "Replay all KGoldrunner recordings and solutions, as fast as possible, "
+        "and report how each level ends."));
+    parser.addHelpOption();
+    parser.addOption (QCommandLineOption (
+        QStringList {QStringLiteral("j"), QStringLiteral("jobs")},
+        QStringLiteral("Number of worker threads (default: one per core)."),
+        QStringLiteral("n")));
+    parser.addOption (QCommandLineOption (
+        QStringLiteral("max-ticks"),
+        QStringLiteral("Stop a replay that runs longer than this."),
+        QStringLiteral("n"), QStringLiteral("1000000")));
+    parser.addPositionalArgument (QStringLiteral("paths"),
+        QStringLiteral("Recording files, or directories containing rec_* and "
+                       "sol_* files (default: the system games)."),
+        QStringLiteral("[paths...]"));
+    parser.process (app);
+
+    QStringList paths = parser.positionalArguments();
+    if (paths.isEmpty()) {
+        QString systemDataDir = QStandardPaths::locate
+                                    (QStandardPaths::AppDataLocation,
+                                     QStringLiteral("system/"),
+                                     QStandardPaths::LocateDirectory);
+        if (systemDataDir.isEmpty()) {
+            QTextStream (stderr) << "Cannot find the system games folder.\n";
+            return 2;
+        }
+        paths << systemDataDir;
+    }
+
+    // Find the recording files.
+    QStringList files;
+    for (const QString & path : std::as_const(paths)) {
+        QFileInfo fileInfo (path);
+        if (fileInfo.isDir()) {
+            QDir directory (path);
+            const QStringList pattern {QStringLiteral("rec_*.txt"),
+                                       QStringLiteral("sol_*.txt"),
+                                       QStringLiteral("rec_*.kgrec"),
+                                       QStringLiteral("sol_*.kgrec")};
+            const QStringList names = directory.entryList
+                                        (pattern, QDir::Files, QDir::Name);
+            for (const QString & name : names) {
+                // As in KGoldrunner, a binary file supersedes a text file.
+                if ((! KGrRecordingIO::isBinary (name)) &&
+                    names.contains (KGrRecordingIO::binaryName (name))) {
+                    continue;
+                }
+                files << directory.filePath (name);
+            }
+        }
+        else if (fileInfo.isFile()) {
+            files << path;
+        }
+        else {
+            QTextStream (stderr) << "Cannot find " << path << "\n";
+            return 2;
+        }
+    }
+
+    // Load all the recordings, with the game data needed to replay them.
+    QElapsedTimer t;
+    t.start();
+
+    KGrGameIO                     io (nullptr);
+    QHash<QString, QHash<QString, KGrGameData *> > gamesInDir;
+    QList<KGrGameData *>          gameList;
+    QList<KGrVerifyJob *>         jobs;
+
+    for (const QString & filePath : std::as_const(files)) {
+        QString dir = QFileInfo (filePath).absolutePath() + QLatin1Char('/');
+        if (! gamesInDir.contains (dir)) {
+            QList<KGrGameData *> dirGames;
+            QString gamePath;
+            io.fetchGameListData (SYSTEM, dir, dirGames, gamePath);
+            QHash<QString, KGrGameData *> & games = gamesInDir [dir];
+            for (KGrGameData * g : std::as_const(dirGames)) {
+                games.insert (g->prefix, g);
+            }
+            gameList << dirGames;
+        }
+        if (! loadRecordings (io, filePath, gamesInDir [dir], jobs)) {
+            QTextStream (stderr) << "Cannot read " << filePath << "\n";
+            return 2;
+        }
+    }
+    qint64 loadTime = t.restart();
+
+    // Replay all the levels in parallel.
+    QThreadPool * pool = QThreadPool::globalInstance();
+    if (parser.isSet (QStringLiteral("jobs"))) {
+        pool->setMaxThreadCount (parser.value (QStringLiteral("jobs")).toInt());
+    }
+    const int maxTicks = parser.value (QStringLiteral("max-ticks")).toInt();
+    for (KGrVerifyJob * job : std::as_const(jobs)) {
+        pool->start (new KGrVerifyTask (job, maxTicks));
+    }
+    pool->waitForDone();
+    qint64 runTime = t.elapsed();
+
+    // Report the results, in the same order as the files and groups.
+    QTextStream out (stdout);
+    int  won      = 0;
+    int  failed   = 0;
+    int  diverged = 0;
+    for (const KGrVerifyJob * job : std::as_const(jobs)) {
+        out << job->fileName << '\t' << job->group << '\t'
+            << resultName (job->result) << '\t' << job->score << '\t'
+            << job->ticks << '\t';
+        if (job->diverged < 0) {
+            out << '-' << '\n';
+        }
+        else {
+            out << job->diverged << '\n';
+            diverged++;
+        }
+        if (job->result == WON_LEVEL) {
+            won++;
+        }
+        else if (job->solution) {
+            failed++;
+        }
+    }
+    out.flush();
+
+    QTextStream (stderr) << jobs.count() << " levels, " << won << " won, "
+                         << failed << " solutions failed, " << diverged
+                         << " replays differed; loaded in "
+                         << loadTime << " ms, replayed in " << runTime
+                         << " ms with " << pool->maxThreadCount()
+                         << " threads\n";
+
+    qDeleteAll (jobs);
+    qDeleteAll (gameList);
+    return ((failed > 0) || (diverged > 0)) ? 1 : 0;
+}
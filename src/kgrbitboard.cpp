@@ -0,0 +1,68 @@
+/*
+    SPDX-FileCopyrightText: 2026 The KGoldrunner Developers
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#include "kgrbitboard.h"
+#include "kgrglobals.h"
+
+KGrBitBoard::KGrBitBoard()
+    :
+    width  (0),
+    height (0),
+    words  (0)
+{
+}
+
+KGrBitBoard::~KGrBitBoard()
+{
+}
+
+void KGrBitBoard::build (const QList<char> & layout,
+                         const int width, const int height)
+{
+    this->width  = width;
+    this->height = height;
+    words        = (width + WordBits - 1) / WordBits;
+    for (int p = 0; p < nPlanes; p++) {
+        planes [p].fill (0, words * height);
+    }
+
+    for (int j = 0; j < height; j++) {
+        const char * cell = layout.constData() + j * width;
+        for (int i = 0; i < width; i++) {
+            Word bit = Word (1) << (i % WordBits);
+            int  k   = j * words + i / WordBits;
+            switch (cell [i]) {
+            case BRICK:
+            case CONCRETE:
+                planes [Support] [k]    |= bit;
+                break;
+            case FBRICK:
+                planes [FalseBrick] [k] |= bit;
+                break;
+            case USEDHOLE:
+                planes [UsedHole] [k]   |= bit;
+                planes [Support] [k]    |= bit;
+                break;
+            case HOLE:
+                planes [Hole] [k]       |= bit;
+                planes [Enterable] [k]  |= bit;
+                break;
+            case LADDER:
+                planes [Ladder] [k]     |= bit;
+                planes [Support] [k]    |= bit;
+                planes [Enterable] [k]  |= bit;
+                break;
+            case BAR:
+                planes [Bar] [k]        |= bit;
+                planes [Enterable] [k]  |= bit;
+                break;
+            default:
+                planes [Enterable] [k]  |= bit;
+                break;
+            }
+        }
+    }
+}
@@ -0,0 +1,91 @@
+/*
+    SPDX-FileCopyrightText: 2026 The KGoldrunner Developers
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#ifndef KGRBITBOARD_H
+#define KGRBITBOARD_H
+
+#include <QList>
+
+/**
+ * The KGrBitBoard class holds the cells of a level grid as bit-planes, one
+ * plane for each property of a cell that decides where a runner can go (can
+ * be entered, is a ladder, can be stood on, etc.).  Each row of a plane is an
+ * array of 64-bit words, with bit (i % 64) of word (i / 64) for the cell in
+ * column i, so a rule can be applied to 64 cells at once with logical
+ * operations and the cells to the left and right can be lined up with shifts.
+ *
+ * KGrLevelGrid::calculateAccess() builds a bit-board from the layout and uses
+ * it to work out the access flags of all the cells, a row at a time.  The
+ * loops over the words of a row have no branches, so that the compiler can
+ * vectorise them.
+ *
+ * @short   KGoldrunner Grid Bit-Planes
+ */
+
+class KGrBitBoard
+{
+public:
+    typedef quint64 Word;
+
+    static constexpr int WordBits = 64;
+
+    enum Plane {
+        Enterable,	///< Not BRICK, CONCRETE, FBRICK or USEDHOLE.
+        FalseBrick,	///< FBRICK: cannot be entered, but can be fallen into.
+        UsedHole,	///< USEDHOLE: a hole with an enemy trapped in it.
+        Hole,		///< HOLE: an open hole.
+        Ladder,		///< LADDER.
+        Bar,		///< BAR.
+        Support,	///< Can stand on it: BRICK, CONCRETE, USEDHOLE or LADDER.
+        nPlanes
+    };
+
+    KGrBitBoard();
+    ~KGrBitBoard();
+
+    /**
+     * Set all the bit-planes from the types of the cells in a grid.
+     *
+     * @param layout       The cell-types, in rows of the given width.
+     * @param width        The width of the grid, in cells.
+     * @param height       The height of the grid, in cells.
+     */
+    void build (const QList<char> & layout, const int width, const int height);
+
+    /// The number of words in each row of a plane.
+    inline int wordsPerRow() const { return words; }
+
+    /// The words of row j in a plane.
+    inline const Word * row (const Plane plane, const int j) const {
+        return planes [plane].constData() + j * words;
+    }
+
+    /// True if the cell at (i, j) has the property of a plane.
+    inline bool test (const Plane plane, const int i, const int j) const {
+        return (row (plane, j) [i / WordBits] >> (i % WordBits)) & 1;
+    }
+
+    /// Word k of a row shifted one cell right, so that the bit for each cell
+    /// is the bit of the cell on its left.
+    static inline Word leftOf (const Word * row, const int k) {
+        return (row [k] << 1) | ((k > 0) ? (row [k - 1] >> (WordBits - 1)) : 0);
+    }
+
+    /// Word k of a row of n words shifted one cell left, so that the bit for
+    /// each cell is the bit of the cell on its right.
+    static inline Word rightOf (const Word * row, const int k, const int n) {
+        return (row [k] >> 1) |
+               ((k + 1 < n) ? (row [k + 1] << (WordBits - 1)) : 0);
+    }
+
+private:
+    int         width;
+    int         height;
+    int         words;
+    QList<Word> planes [nPlanes];
+};
+
+#endif // KGRBITBOARD_H
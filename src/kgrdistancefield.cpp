@@ -0,0 +1,64 @@
+/*
+    SPDX-FileCopyrightText: 2026 The KGoldrunner Developers
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#include "kgrdistancefield.h"
+#include "kgrlevelgrid.h"
+
+KGrDistanceField::KGrDistanceField()
+    :
+    width (0)
+{
+}
+
+KGrDistanceField::~KGrDistanceField()
+{
+}
+
+void KGrDistanceField::build (KGrLevelGrid * pGrid, const QList<int> & targets,
+                              const bool hero)
+{
+    width      = pGrid->gridWidth();
+    int height = pGrid->levelHeight() + 2 * ConcreteWall;
+    dist.fill (Unreachable, width * height);
+    queue.clear();
+
+    for (const int position : targets) {
+        if (dist.at (position) != 0) {
+            dist [position] = 0;
+            queue.append (position);
+        }
+    }
+
+    // Search backwards: from each cell, find the neighbours whose moves lead
+    // into it.  A runner that cannot stand can only fall.
+    const Direction towards [4] = {RIGHT, LEFT, DOWN, UP};
+    for (int n = 0; n < queue.count(); n++) {
+        int position = queue.at (n);
+        int i = position % width;
+        int j = position / width;
+        int d = dist.at (position) + 1;
+        for (const Direction dirn : towards) {
+            // The neighbour from which a move in direction dirn comes here.
+            int fromI = i - movement [dirn][X];
+            int fromJ = j - movement [dirn][Y];
+            if ((fromI < 1) || (fromI >= width - 1) ||
+                (fromJ < 1) || (fromJ >= height - 1)) {
+                continue;
+            }
+            int from = fromI + fromJ * width;
+            if (dist.at (from) != Unreachable) {
+                continue;
+            }
+            Flags moves = hero ? pGrid->heroMoves  (fromI, fromJ) :
+                                 pGrid->enemyMoves (fromI, fromJ);
+            if ((moves & dFlag [dirn]) &&
+                ((dirn == DOWN) || (moves & dFlag [STAND]))) {
+                dist [from] = d;
+                queue.append (from);
+            }
+        }
+    }
+}
@@ -0,0 +1,66 @@
+/*
+    SPDX-FileCopyrightText: 2026 The KGoldrunner Developers
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#ifndef KGRDISTANCEFIELD_H
+#define KGRDISTANCEFIELD_H
+
+#include <QList>
+
+class KGrLevelGrid;
+
+/**
+ * The KGrDistanceField class holds, for each cell of a level, the number of
+ * moves an enemy needs to reach the nearest of a set of target cells (e.g.
+ * the hero's cell or the cells that have gold in them).  The moves are those
+ * that KGrLevelGrid::enemyMoves() allows, with an enemy that cannot stand
+ * only able to fall, so an enemy can find its way by going to any
+ * neighbouring cell that is nearer, without searching the grid.
+ *
+ * The field is found by a breadth-first search backwards from the targets, in
+ * time proportional to the number of cells.  There is no incremental update: a
+ * change to the grid or the targets means building the whole field again.
+ * KGrScavengerRules shares its fields between all the enemies and builds them
+ * again only when they may be out of date, but in play that is often (see
+ * KGrScavengerRules).  Enemies standing on other enemies are ignored, as in
+ * KGrNavField.  A field can also be built with the hero's moves (see
+ * KGrLevelGrid::heroMoves()), as KGrSolver does to guide its search towards
+ * the gold.
+ *
+ * @short   KGoldrunner Enemy Distance Field
+ */
+
+class KGrDistanceField
+{
+public:
+    /// The distance of a cell from which no target can be reached.
+    static constexpr int Unreachable = 0x7fffffff;
+
+    KGrDistanceField();
+    ~KGrDistanceField();
+
+    /**
+     * Find the distance from each cell of a grid to the nearest target.
+     *
+     * @param pGrid        The grid of the level, with its access flags.
+     * @param targets      The target cells, as offsets in the grid (i + j * w).
+     * @param hero         If true, use the hero's moves, not the enemies' (e.g.
+     *                     for KGrSolver to find how far the hero is from gold).
+     */
+    void build (KGrLevelGrid * pGrid, const QList<int> & targets,
+                const bool hero = false);
+
+    /// The number of moves from cell (i, j) to the nearest target.
+    inline int distance (const int i, const int j) const {
+        return dist [i + j * width];
+    }
+
+private:
+    int          width;
+    QList<int>   dist;
+    QList<int>   queue;		// Cells to visit, kept to save reallocation.
+};
+
+#endif // KGRDISTANCEFIELD_H
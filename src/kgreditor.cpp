@@ -11,6 +11,7 @@
 #include "kgrselector.h"
 #include "kgrdialog.h"
 #include "kgrgameio.h"
+#include "kgrlevelchecker.h"
 #include <KLocalizedString>
 #include <ctype.h>
 #include <QTimer>
@@ -31,7 +32,9 @@ KGrEditor::KGrEditor (KGrView * theView,
     gameList         (pGameList),
     editObj          (BRICK),		// Default edit-object.
     shouldSave       (false),
-    mouseDisabled    (true)
+    mouseDisabled    (true),
+    checker          (new KGrLevelChecker (this)),
+    checkNeeded      (false)
 {
     levelData.width  = FIELDWIDTH;	// Default values for a brand new game.
     levelData.height = FIELDHEIGHT;
@@ -45,6 +48,7 @@ KGrEditor::KGrEditor (KGrView * theView,
     connect(view, &KGrView::mouseClick, this, &KGrEditor::doEdit);
     connect(view, &KGrView::mouseLetGo, this, &KGrEditor::endEdit);
     connect(this, &KGrEditor::getMousePos, scene, &KGrScene::getMousePos);
+    connect(checker, &KGrLevelChecker::checked, this, &KGrEditor::showWarnings);
 }
 
 KGrEditor::~KGrEditor()
@@ -77,9 +81,13 @@ bool KGrEditor::createLevel (int pGameIndex)
     // Ignore player input from the mouse while the screen is set up.
     mouseDisabled = true;
 
-    levelData.level = 0;
-    levelData.name  = "";
-    levelData.hint  = "";
+    levelData.level  = 0;
+    levelData.width  = FIELDWIDTH;	// A new level has the standard size.
+    levelData.height = FIELDHEIGHT;
+    levelData.name   = "";
+    levelData.hint   = "";
+    levelData.digWhileFalling = gameList.at (gameIndex)->digWhileFalling;
+    scene->setGridSize (levelData.width, levelData.height);
     initEdit();
 
     // Clear the playfield.
@@ -154,12 +162,19 @@ void KGrEditor::loadEditLevel (int lev)
     // If system game or ENDE screen, choose system dir, else choose user dir.
     const QString dir = ((gameList.at(gameIndex)->owner == SYSTEM) ||
                          (lev == 0)) ? systemDataDir : userDataDir;
-    // Read the level data.
+    // Read the level data.  The level can override the game's setting of
+    // dig-while-falling.
+    d.digWhileFalling = gameList.at(gameIndex)->digWhileFalling;
     if (! io->readLevelData (dir, gameList.at(gameIndex)->prefix, lev, d)) {
         return;		// If I/O failed, no load.
     }
 
     editLevel = lev;
+    levelData.width  = d.width;		// The level can have any size.
+    levelData.height = d.height;
+    levelData.digWhileFalling = d.digWhileFalling;
+    levelData.layout.resize (levelData.width * levelData.height);
+    scene->setGridSize (levelData.width, levelData.height);
     initEdit();
 
     int  i, j;
@@ -257,12 +272,20 @@ bool KGrEditor::saveLevelFile()
     }
 
     // Open the output file.
+    KGrGameIO::releaseFile (filePath);
     if (! levelFile.open (QIODevice::WriteOnly)) {
         KGrMessage::information (view, i18nc("@title:window", "Save Level"),
                 i18n ("Cannot open file '%1' for output.", filePath));
         return false;
     }
 
+    // Save the size of the level, if it is not the standard size.
+    if ((levelData.width != FIELDWIDTH) || (levelData.height != FIELDHEIGHT)) {
+        levelFile.write (QByteArray (".size ") +
+                         QByteArray::number (levelData.width) + ' ' +
+                         QByteArray::number (levelData.height) + '\n');
+    }
+
     // Save the level - row by row.
     for (j = 1; j <= levelData.height; ++j) {
         for (i = 1; i <= levelData.width; ++i) {
@@ -437,6 +460,7 @@ bool KGrEditor::deleteLevelFile (int pGameIndex, int level)
     QFile levelFile (filePath);
 
     // Delete the file for the selected game and level.
+    KGrGameIO::releaseFile (filePath);
     if (levelFile.exists()) {
         if (selectedLevel < gameList.at (n)->nLevels) {
             switch (KGrMessage::warning (view, i18nc("@title:window", "Delete Level"),
@@ -706,6 +730,19 @@ void KGrEditor::insertEditObj (int i, int j, char obj)
     }
 
     setEditableCell (i, j, obj);
+
+    // Check the layout when all the cells of this change have been painted
+    // (e.g. a whole level, when it is loaded).
+    if (! checkNeeded) {
+        checkNeeded = true;
+        QTimer::singleShot (0, this, &KGrEditor::checkLevel);
+    }
+}
+
+void KGrEditor::checkLevel()
+{
+    checkNeeded = false;
+    checker->check (levelData);
 }
 
 char KGrEditor::editableCell (int i, int j)
@@ -777,6 +814,7 @@ bool KGrEditor::saveGameData (Owner o)
     QFile c (filePath);
 
     // Open the output file.
+    KGrGameIO::releaseFile (filePath);
     if (! c.open (QIODevice::WriteOnly)) {
         KGrMessage::information (view, i18nc("@title:window", "Save Game Info"),
                 i18n ("Cannot open file '%1' for output.", filePath));
@@ -938,4 +976,9 @@ void KGrEditor::endEdit (int button)
     }
 }
 
+void KGrEditor::showWarnings (const QList<int> & lostGold, const bool exitOK)
+{
+    scene->setEditWarnings (lostGold, ! exitOK);
+}
+
 #include "moc_kgreditor.cpp"
@@ -14,6 +14,7 @@
 class KGrView;
 class KGrScene;
 class KGrGameIO;
+class KGrLevelChecker;
 class QTimer;
 
 /**
@@ -225,6 +226,15 @@ private:
 
     bool mouseDisabled;
 
+    KGrLevelChecker * checker;	// Finds gold or exits the hero cannot reach.
+    bool checkNeeded;		// True if a check of the layout is due.
+
+    /**
+     * Send the layout to be checked on a worker thread, after each change of
+     * one or more cells.  Called once all the changes have been made.
+     */
+    void checkLevel();
+
 private Q_SLOTS:
     /**
      * Start painting or erasing cells on the layout.  Triggered by pressing
@@ -247,6 +257,15 @@ private Q_SLOTS:
      * @param button The button being released: left for paint, right for erase.
      */
     void endEdit (int button);
+
+    /**
+     * Show the results of the latest check of the layout as warnings on the
+     * scene.
+     *
+     * @param lostGold The cells of the gold that the hero cannot reach.
+     * @param exitOK   True if the hero can reach the top row at the end.
+     */
+    void showWarnings (const QList<int> & lostGold, const bool exitOK);
 };
 
 #endif // KGREDITOR_H
@@ -0,0 +1,165 @@
+/*
+    SPDX-FileCopyrightText: 2026 The KGoldrunner Developers
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#include "kgrenvironment.h"
+#include "kgrlevelgrid.h"
+#include "kgrlevelobserver.h"
+#include "kgrlevelplayer.h"
+#include "kgrrandom.h"
+#include "kgrrunnerstore.h"
+
+#include <QThread>
+
+/// One copy of the level, with its own level player.
+class KGrEnvironment::Instance
+{
+public:
+    Instance() : player (nullptr, nullptr) {}
+
+    KGrRecording             recording;	// The level and the play so far.
+    KGrLevelObserver         observer;	// No graphics: all calls do nothing.
+    KGrLevelPlayer           player;
+    KGrLevelPlayer::Snapshot start;	// The level before the first tick.
+};
+
+KGrEnvironment::KGrEnvironment (const KGrRecording & level,
+                                const int instances, const int threads)
+    :
+    count       (qMax (instances, 0)),
+    levelWidth  (level.width),
+    levelHeight (level.height),
+    runnerCount (0),
+    points      (1),
+    threadCount ((threads > 0) ? threads : QThread::idealThreadCount())
+{
+    const quint64 seed = (level.seed != 0) ? level.seed
+                                           : KGrRandom::DefaultSeed;
+    for (int n = 0; n < count; n++) {
+        Instance * in = new Instance;
+        in->recording             = level;
+        in->recording.controlMode = KEYBOARD;
+        in->recording.keyOption   = CLICK_KEY;
+        in->recording.seed        = seed + n;
+        in->recording.content     = QByteArray (1,
+                                               static_cast<char>(END_CODE));
+        in->recording.draws.clear();
+        in->recording.checks.clear();
+
+        in->player.init (&in->observer, &in->recording, false, false, false);
+        in->player.setTimeScale (in->recording.speed);
+        in->player.prepareToPlay();
+        in->start = in->player.saveState();
+        instanceList.append (in);
+    }
+    if (count > 0) {
+        int x, y;
+        KGrLevelPlayer & player = instanceList.first()->player;
+        points      = player.heroPosition (x, y);
+        runnerCount = player.runnerStore()->gridX.count();
+    }
+    pool.setMaxThreadCount (threadCount);
+
+    cellBuffer.fill   (FREE, count * levelWidth * levelHeight);
+    posBuffer.fill    (0,      count * runnerCount * 2);
+    resultBuffer.fill (NORMAL, count);
+    goldBuffer.fill   (0,      count);
+    cellData   = cellBuffer.data();
+    posData    = posBuffer.data();
+    resultData = resultBuffer.data();
+    goldData   = goldBuffer.data();
+
+    // Copy the whole of each layout once: after that, only the changes.
+    for (int n = 0; n < count; n++) {
+        KGrLevelGrid * grid  = instanceList.at (n)->player.levelGrid();
+        char *         cells = cellData + n * levelWidth * levelHeight;
+        for (int j = 0; j < levelHeight; j++) {
+            for (int i = 0; i < levelWidth; i++) {
+                cells [i + j * levelWidth] =
+                        grid->cellType (i + ConcreteWall, j + ConcreteWall);
+            }
+        }
+        grid->takeChanges();
+        observe (n);
+    }
+}
+
+KGrEnvironment::~KGrEnvironment()
+{
+    qDeleteAll (instanceList);
+}
+
+void KGrEnvironment::reset()
+{
+    for (int n = 0; n < count; n++) {
+        reset (n);
+    }
+}
+
+void KGrEnvironment::reset (const int n)
+{
+    Instance * in = instanceList.at (n);
+    in->player.restoreState (in->start);
+    resultData [n] = NORMAL;
+    observe (n);
+}
+
+void KGrEnvironment::step (const QList<Direction> & actions)
+{
+    const int chunks = qMin (threadCount, count);
+    if (chunks <= 1) {
+        for (int n = 0; n < count; n++) {
+            stepInstance (n, actions.at (n));
+        }
+        return;
+    }
+
+    // Give each thread an equal share of the instances, in one piece.
+    for (int c = 0; c < chunks; c++) {
+        const int first = (c * count) / chunks;
+        const int last  = ((c + 1) * count) / chunks;
+        pool.start ([this, &actions, first, last] () {
+            for (int n = first; n < last; n++) {
+                stepInstance (n, actions.at (n));
+            }
+        });
+    }
+    pool.waitForDone();
+}
+
+void KGrEnvironment::stepInstance (const int n, const Direction action)
+{
+    if (resultData [n] != NORMAL) {
+        return;				// The level has ended: wait for reset.
+    }
+    resultData [n] = instanceList.at (n)->player.step (action);
+    observe (n);
+}
+
+void KGrEnvironment::observe (const int n)
+{
+    KGrLevelPlayer & player = instanceList.at (n)->player;
+    KGrLevelGrid *   grid   = player.levelGrid();
+    const int        gridW  = grid->gridWidth();
+
+    char * cells = cellData + n * levelWidth * levelHeight;
+    for (const int position : grid->takeChanges()) {
+        int i = position % gridW - ConcreteWall;
+        int j = position / gridW - ConcreteWall;
+        if ((i >= 0) && (i < levelWidth) && (j >= 0) && (j < levelHeight)) {
+            cells [i + j * levelWidth] = grid->cellType (i + ConcreteWall,
+                                                         j + ConcreteWall);
+        }
+    }
+
+    const KGrRunnerStore * store  = player.runnerStore();
+    const int              offset = ConcreteWall * points;
+    qint16 *               pos    = posData + n * runnerCount * 2;
+    for (int id = 0; id < runnerCount; id++) {
+        pos [2 * id]     = (qint16) (store->gridX.at (id) - offset);
+        pos [2 * id + 1] = (qint16) (store->gridY.at (id) - offset);
+    }
+    goldData [n] = player.goldLeft();
+}
@@ -0,0 +1,146 @@
+/*
+    SPDX-FileCopyrightText: 2026 The KGoldrunner Developers
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#ifndef KGRENVIRONMENT_H
+#define KGRENVIRONMENT_H
+
+#include "kgrglobals.h"
+
+#include <QByteArray>
+#include <QList>
+#include <QThreadPool>
+
+/**
+ * The KGrEnvironment class runs many copies (instances) of a level side by
+ * side, for programs that learn to play KGoldrunner or test players that do.
+ * Each instance has its own KGrLevelPlayer, played live in fixed steps, with
+ * no timer, no graphics and no signals connected.  All the instances are
+ * stepped together: step() takes one key for each instance and plays one
+ * tick in each, then the observations of all the instances can be read from
+ * flat arrays, laid out instance after instance.
+ *
+ *  - cells():     the type of each cell (FREE, BRICK, HOLE, NUGGET, etc.),
+ *                 width() * height() bytes per instance, row by row, from the
+ *                 top left.  Only the cells that change are copied each tick.
+ *  - positions(): the X and Y positions of the hero and then each enemy, in
+ *                 grid-points from the top left of the layout (pointsPerCell()
+ *                 points per cell), 2 * runners() numbers per instance.
+ *  - results():   NORMAL while the level is in play, WON_LEVEL or DEAD at
+ *                 the end.  An instance that has ended is not stepped again
+ *                 until it is reset.
+ *  - goldLeft():  the number of pieces of gold still to be collected.
+ *
+ * The instances share no data, so step() can divide them between a number of
+ * threads, and stepInstance() can be called for different instances on
+ * different threads at the same time.  The arrays are kept in place, so the
+ * pointers to them stay valid for the life of the environment.
+ *
+ * Each instance has a seed for its random numbers (see KGrRandom): the seed of
+ * the level plus the number of the instance, so that the enemies behave
+ * differently in each instance.  An instance that is reset goes back to its
+ * start, with the same seed, so its enemies behave the same way again if the
+ * hero does.
+ *
+ * @short   KGoldrunner Multi-Level Environment
+ */
+
+class KGrEnvironment
+{
+public:
+    /**
+     * The constructor of KGrEnvironment.
+     *
+     * @param level      The level, as set up by KGrSolver::setUpLevel(), with
+     *                   the KEYBOARD control mode and the CLICK_KEY option.
+     * @param instances  The number of copies of the level to run.
+     * @param threads    The number of threads that step() uses (default 1,
+     *                   the calling thread only), or 0 for one per core.
+     */
+    KGrEnvironment (const KGrRecording & level, const int instances,
+                    const int threads = 1);
+    ~KGrEnvironment();
+
+    /// The number of instances.
+    inline int instances()     const { return count; }
+
+    /// The width of the level, in cells.
+    inline int width()         const { return levelWidth; }
+
+    /// The height of the level, in cells.
+    inline int height()        const { return levelHeight; }
+
+    /// The number of runners in each instance: the hero and the enemies.
+    inline int runners()       const { return runnerCount; }
+
+    /// The number of grid-points in each cell, for positions().
+    inline int pointsPerCell() const { return points; }
+
+    /// Put all the instances back to the start of the level.
+    void reset ();
+
+    /// Put one instance back to the start of the level.
+    void reset (const int n);
+
+    /**
+     * Play one tick in each instance that has not ended.
+     *
+     * @param actions    The key for each instance: a Direction from STAND to
+     *                   DIG_LEFT, as in KGrLevelPlayer::step().
+     */
+    void step (const QList<Direction> & actions);
+
+    /**
+     * Play one tick in one instance, if it has not ended.  Can be called for
+     * different instances on different threads at the same time, but not at
+     * the same time as any other method.
+     *
+     * @param n          The number of the instance.
+     * @param action     The key: a Direction from STAND to DIG_LEFT.
+     */
+    void stepInstance (const int n, const Direction action);
+
+    /// The cell types of all the instances (see the class description).
+    inline const char *   cells()     const { return cellBuffer.constData(); }
+
+    /// The positions of the runners in all the instances.
+    inline const qint16 * positions() const { return posBuffer.constData(); }
+
+    /// The results of all the instances: NORMAL, WON_LEVEL or DEAD.
+    inline const int *    results()   const { return resultBuffer.constData(); }
+
+    /// The gold left in each instance.
+    inline const int *    goldLeft()  const { return goldBuffer.constData(); }
+
+private:
+    class Instance;
+
+    // Copy the cells that have changed and the positions of the runners of
+    // one instance into the arrays.
+    void observe (const int n);
+
+    int               count;
+    int               levelWidth;
+    int               levelHeight;
+    int               runnerCount;
+    int               points;
+    int               threadCount;
+    QList<Instance *> instanceList;
+    QThreadPool       pool;
+
+    QByteArray        cellBuffer;
+    QList<qint16>     posBuffer;
+    QList<int>        resultBuffer;
+    QList<int>        goldBuffer;
+
+    // Pointers to the data of the arrays, which never move, so that threads
+    // can write to them without making copies (see QList::data()).
+    char *            cellData;
+    qint16 *          posData;
+    int *             resultData;
+    int *             goldData;
+};
+
+#endif // KGRENVIRONMENT_H
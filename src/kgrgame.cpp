@@ -22,20 +22,25 @@
 #include "kgrlevelplayer.h"
 #include "kgrdialog.h"
 #include "kgrgameio.h"
+#include "kgrrecordingio.h"
+#include "kgrsolver.h"
 
 #include <iostream>
 #include <cstdlib>
 
+#include <QApplication>
 #include <QByteArray>
 #include <QDate>
 #include <QDateTime>
 #include <QLabel>
 #include <QHeaderView>
+#include <QProgressDialog>
 #include <QPushButton>
 #include <QSpacerItem>
 #include <QStandardPaths>
 #include <QStringList>
 #include <QTextStream>
+#include <QThread>
 #include <QTimer>
 #include <QTreeWidget>
 #include <QTreeWidgetItem>
@@ -68,6 +73,9 @@
 #define ProgramPause    false
 #define NewLevel        true
 
+// Milliseconds allowed for finding a solution if none has been recorded.
+#define SolverTimeLimit 20000
+
 /******************************************************************************/
 /***********************    KGOLDRUNNER GAME CLASS    *************************/
 /******************************************************************************/
@@ -88,7 +96,16 @@ KGrGame::KGrGame (KGrView * theView,
         // mainDemoName  ("CM"), // IDW test.
         demoType      (DEMO),
         startupDemo   (false),
+        replayTicks   (0),
         programFreeze (false),
+        solver        (nullptr),
+        solution      (nullptr),
+        solverThread  (nullptr),
+        solverProgress (nullptr),
+        solverWon     (false),
+        solverCancelled (false),
+        solverGame    (0),
+        solverLevel   (0),
         effects       (nullptr),
         fx            (NumSounds),
         soundOn       (false),
@@ -107,10 +124,20 @@ KGrGame::KGrGame (KGrView * theView,
     //qCDebug(KGOLDRUNNER_LOG) << "RANDOM NUMBER GENERATOR INITIALISED";
 
     scene->setReplayMessage (i18n("Click anywhere to begin live play"));
+
+    // Clicks on the timeline of a replay go to that point in the replay.
+    connect(view, &KGrView::seekReplay, this, &KGrGame::seekReplay);
 }
 
 KGrGame::~KGrGame()
 {
+    if (solverThread) {			// Do not leave a search running.
+        solver->stop();
+        solverThread->wait();
+        delete solverThread;
+        delete solver;
+        delete solution;
+    }
     qDeleteAll(gameList);
     delete randomGen;
     delete levelPlayer;
@@ -120,10 +147,6 @@ KGrGame::~KGrGame()
 #endif
 }
 
-// Flags to control author's debugging aids.
-bool KGrGame::bugFix  = false;		// Start game with dynamic bug-fix OFF.
-bool KGrGame::logging = false;		// Start game with dynamic logging OFF.
-
 bool KGrGame::modeSwitch (const int action,
                           int & selectedGame, int & selectedLevel)
 {
@@ -309,6 +332,7 @@ void KGrGame::editActions (const int action)
         else {
             // Edit failed or was cancelled, so close the editor.
             Q_EMIT setEditMenu (false);	// Disable edit menu items and toolbar.
+            scene->setEditWarnings (QList<int>(), false);
             delete editor;
             editor = nullptr;
         }
@@ -507,16 +531,30 @@ void KGrGame::initGame()
 bool KGrGame::getRecordingName (const QString & dir, const QString & pPrefix,
                                 QString & filename)
 {
-    QString recFile = dir + QLatin1String("rec_") + pPrefix + QLatin1String(".txt");
-    QFileInfo fileInfo (recFile);
-    bool recOK = fileInfo.exists() && fileInfo.isReadable();
+    // Prefer the binary format, which is used for all new recordings.
+    auto findFile = [] (const QString & textFile, QString & found) {
+        const QString names[2] = {KGrRecordingIO::binaryName (textFile),
+                                  textFile};
+        for (const QString & name : names) {
+            QFileInfo fileInfo (name);
+            if (fileInfo.exists() && fileInfo.isReadable()) {
+                found = name;
+                return true;
+            }
+        }
+        return false;
+    };
+
+    QString recFile;
+    bool recOK = findFile (dir + QLatin1String("rec_") + pPrefix +
+                           QLatin1String(".txt"), recFile);
     filename = QString ();
 
     if (demoType == SOLVE) {
 	// Look for a solution-file name in User or System area.
-    QString solFile = dir + QLatin1String("sol_") + pPrefix + QLatin1String(".txt");
-	fileInfo.setFile (solFile);
-	bool solOK = fileInfo.exists() && fileInfo.isReadable();
+    QString solFile;
+	bool solOK = findFile (dir + QLatin1String("sol_") + pPrefix +
+	                       QLatin1String(".txt"), solFile);
 	if (solOK) {
 	    filename = solFile;	// Accept sol_* in User or System area.
 	    return true;
@@ -546,8 +584,7 @@ bool KGrGame::startDemo (const Owner demoOwner, const QString & pPrefix,
     }
     dbk1 << "Owner" << demoOwner << "type" << demoType
          << pPrefix << levelNo << "filepath" << filepath;
-    KConfig     config (filepath, KConfig::SimpleConfig);
-    QStringList demoList = config.groupList();
+    QStringList demoList = KGrRecordingIO::groupList (filepath);
     dbk1 << "DEMO LIST" << demoList.count() << demoList;
 
     // Find the required level (e.g. CM007) in the list available on the file.
@@ -571,6 +608,7 @@ bool KGrGame::startDemo (const Owner demoOwner, const QString & pPrefix,
                           demoList.count() : levelNo;
         if (levelPlayer) {
             levelPlayer->prepareToPlay();
+            showReplayTimeline();
         }
         qCDebug(KGOLDRUNNER_LOG) << "DEMO started ..." << filepath << pPrefix << levelNo;
         return true;
@@ -653,6 +691,33 @@ void KGrGame::startInstantReplay()
     setPlayback (true);
     setupLevelPlayer();
     levelPlayer->prepareToPlay();
+    showReplayTimeline();
+}
+
+void KGrGame::showReplayTimeline()
+{
+    // Only the replays of the player's own levels can be scrubbed through.
+    replayTicks = 0;
+    if (levelPlayer && playback &&
+        ((demoType == INSTANT_REPLAY) || (demoType == REPLAY_LAST))) {
+        replayTicks = qMax (levelPlayer->replayLength(), 0);
+    }
+    scene->setReplayProgress (levelPlayer ? levelPlayer->tickCount() : 0,
+                              replayTicks);
+}
+
+void KGrGame::seekReplay (const int tick)
+{
+    if (levelPlayer && playback && (replayTicks > 0)) {
+        levelPlayer->seek (tick);	// Emits tickPlayed() for the timeline.
+    }
+}
+
+void KGrGame::showReplayProgress (const int tick)
+{
+    if (replayTicks > 0) {
+        scene->setReplayProgress (tick, replayTicks);
+    }
 }
 
 void KGrGame::replayLastLevel()
@@ -831,12 +896,11 @@ void KGrGame::runReplay (const int action,
         }
         else {			// If not, look for a released solution.
             setPlayback (true);	// Set playback again (startDemo() cleared it).
-            if (! startDemo
+            if (startDemo
                 (SYSTEM, gameList.at (selectedGame)->prefix, selectedLevel)) {
-                KGrMessage::information (view, i18nc("@title:window", "Show a Solution"),
-                    i18n ("Sorry, although all levels of KGoldrunner can be "
-                          "solved, no solution has been recorded yet for the "
-                          "level you selected."), QStringLiteral("Show_noSolutionRecorded"));
+            }
+            else if (! solveLevel (selectedGame, selectedLevel)) {
+                noSolution();	// Else solverFinished() shows any solution.
             }
         }
     }
@@ -883,6 +947,7 @@ bool KGrGame::playLevel (const Owner fileOwner, const QString & prefix,
     // If the game-editor is active, terminate it.
     if (editor) {
         Q_EMIT setEditMenu (false);	// Disable edit menu items and toolbar.
+        scene->setEditWarnings (QList<int>(), false);
         delete editor;
         editor = nullptr;
     }
@@ -939,9 +1004,22 @@ void KGrGame::setupLevelPlayer()
 {
     levelPlayer = new KGrLevelPlayer (this, randomGen);
 
-    levelPlayer->init (view, recording, playback, gameFrozen);
+    // Hide the timeline of any previous replay.
+    replayTicks = 0;
+    scene->setReplayProgress (0, 0);
+
+    levelPlayer->init (scene, recording, playback, gameFrozen);
     levelPlayer->setTimeScale (recording->speed);
 
+    // Connect mouse-clicks from KGrView to the digging slot.
+    connect(view, &KGrView::mouseClick, levelPlayer, &KGrLevelPlayer::doDig);
+
+    // Connect the scoring and the sounds.
+    connect(levelPlayer, &KGrLevelPlayer::incScore, this, &KGrGame::incScore);
+    connect(levelPlayer, &KGrLevelPlayer::playSound, this, &KGrGame::playSound);
+    connect(levelPlayer, &KGrLevelPlayer::tickPlayed,
+            this, &KGrGame::showReplayProgress);
+
     // Use queued connections here, to ensure that levelPlayer has finished
     // executing and can be deleted when control goes to the relevant slot.
     connect(levelPlayer, &KGrLevelPlayer::endLevel, this, &KGrGame::endLevel, Qt::QueuedConnection);
@@ -1363,6 +1441,10 @@ void KGrGame::setPlayback (const bool onOff)
         Q_EMIT setAvail  (QStringLiteral("decrease_speed"),  enableDisable);
     }
     scene->showReplayMessage (onOff);
+    if (! onOff) {
+        replayTicks = 0;
+        scene->setReplayProgress (0, 0);	// Hide the timeline.
+    }
     playback = onOff;
 }
 
@@ -2050,7 +2132,7 @@ void KGrGame::saveSolution (const QString & prefix, const int levelNo)
     saveRecording (QStringLiteral("sol_"));
 	KGrMessage::information (view, i18nc("@title:window", "Save a Solution"),
             i18n ("Your solution to level %1 has been saved on file %2",
-                  levelNo, userDataDir + QStringLiteral("sol_") + prefix + QStringLiteral(".txt")));
+                  levelNo, userDataDir + QStringLiteral("sol_") + prefix + QStringLiteral(".kgrec")));
     }
     else {
 	KGrMessage::information (view, i18nc("@title:window", "Save a Solution"),
@@ -2070,9 +2152,7 @@ bool KGrGame::initRecordingData (const Owner fileOwner, const QString & prefix,
 {
     // Initialise the recording.
     delete recording;
-    recording = new KGrRecording;
-    recording->content.fill (0, 4000);
-    recording->draws.fill   (0, 400);
+    recording = new KGrRecording;	// The content and draws grow in play.
 
     // If system game or ENDE, choose system dir, else choose user dir.
     const QString dir = ((fileOwner == SYSTEM) || (levelNo == 0)) ?
@@ -2123,61 +2203,137 @@ bool KGrGame::initRecordingData (const Owner fileOwner, const QString & prefix,
         recording->speed       = timeScale;
         recording->controlMode = controlMode;
         recording->keyOption   = holdKeyOption;
-        recording->content [0] = static_cast<char>(0xff);
+        recording->content     = QByteArray (1, static_cast<char>(END_CODE));
+
+        // Store a seed for the random numbers, rather than every number drawn.
+        recording->seed        = randomGen->generate64() | 1;
     }
     return true;
 }
 
-void KGrGame::saveRecording (const QString & filetype)
+bool KGrGame::solveLevel (const int selectedGame, const int selectedLevel)
 {
-    QString filename = userDataDir + filetype + prefix + QStringLiteral(".txt");
-    QString groupName = prefix +
-                        QString::number(recording->level).rightJustified(3,QLatin1Char('0'));
-    //qCDebug(KGOLDRUNNER_LOG) << filename << groupName;
+    if (solverThread) {
+        return false;			// A search is already running.
+    }
+    KGrGameData * gameData = gameList.at (selectedGame);
+    const QString dir = ((gameData->owner == SYSTEM) || (selectedLevel == 0)) ?
+                        systemDataDir : userDataDir;
 
-    KConfig config (filename, KConfig::SimpleConfig);
-    KConfigGroup configGroup = config.group (groupName);
-    configGroup.writeEntry ("DateTime", recording->dateTime);
-    configGroup.writeEntry ("Owner",    (int) recording->owner);
-    configGroup.writeEntry ("Rules",    (int) recording->rules);
-    configGroup.writeEntry ("Prefix",   recording->prefix);
-    configGroup.writeEntry ("GameName", recording->gameName);
-    configGroup.writeEntry ("Level",    recording->level);
-    configGroup.writeEntry ("Width",    recording->width);
-    configGroup.writeEntry ("Height",   recording->height);
-    configGroup.writeEntry ("Layout",   recording->layout);
-    configGroup.writeEntry ("Name",     recording->levelName);
-    configGroup.writeEntry ("Hint",     recording->hint);
-    configGroup.writeEntry ("DigWhileFalling", recording->digWhileFalling);
-    configGroup.writeEntry ("Lives",    (int) recording->lives);
-    configGroup.writeEntry ("Score",    (int) recording->score);
-    configGroup.writeEntry ("Speed",    (int) recording->speed);
-    configGroup.writeEntry ("Mode",     (int) recording->controlMode);
-    configGroup.writeEntry ("KeyOption", (int)recording->keyOption);
-
-    QList<int> bytes;
-    int ch = 0;
-    int n  = recording->content.size();
-    for (int i = 0; i < n; i++) {
-        ch = (uchar)(recording->content.at(i));
-        bytes.append (ch);
-        if (ch == 0)
-            break;
+    // Read the level, with its own dig-while-falling setting, if any.
+    KGrGameIO    io (view);
+    KGrLevelData levelData;
+    levelData.digWhileFalling = gameData->digWhileFalling;
+    if (! io.readLevelData (dir, gameData->prefix, selectedLevel, levelData)) {
+        return false;
     }
-    configGroup.writeEntry ("Content", bytes);
 
-    bytes.clear();
-    ch = 0;
-    n = recording->draws.size();
-    for (int i = 0; i < n; i++) {
-        ch = (uchar)(recording->draws.at(i));
-        bytes.append (ch);
-        if (ch == 0)
-            break;
+    KGrRecording level;
+    KGrSolver::setUpLevel (level, *gameData, levelData, selectedLevel);
+    level.levelName = (levelData.name.size() > 0) ?
+                      i18n (levelData.name.constData()) : QString();
+    level.hint      = (levelData.hint.size() > 0) ?
+                      i18n (levelData.hint.constData()) : QString();
+
+    // Search for a way to win the level, for a limited time, on another
+    // thread, so that the window can still be redrawn and the user can cancel.
+    solver          = new KGrSolver (level);
+    solver->setTimeLimit (SolverTimeLimit);
+    solution        = new KGrRecording;
+    solverWon       = false;
+    solverCancelled = false;
+    solverGame      = selectedGame;
+    solverLevel     = selectedLevel;
+    freeze (ProgramPause, true);
+
+    solverProgress = new QProgressDialog
+                        (i18n ("Searching for a solution to this level..."),
+                         KStandardGuiItem::cancel().text(), 0, 0, view);
+    solverProgress->setWindowTitle (i18nc("@title:window", "Show a Solution"));
+    solverProgress->setWindowModality (Qt::WindowModal);
+    solverProgress->setMinimumDuration (0);
+    connect(solverProgress, &QProgressDialog::canceled,
+            this, &KGrGame::cancelSolver);
+
+    solverThread = QThread::create ([this] () {
+        solverWon = solver->solve (*solution);
+    });
+    connect(solverThread, &QThread::finished, this, &KGrGame::solverFinished);
+    solverThread->start();
+    solverProgress->show();
+    return true;
+}
+
+void KGrGame::cancelSolver()
+{
+    if (solver) {
+        solverCancelled = true;
+        solver->stop();			// solverFinished() will follow soon.
+    }
+}
+
+void KGrGame::solverFinished()
+{
+    qCDebug(KGOLDRUNNER_LOG) << "Solver" << gameList.at (solverGame)->prefix
+                             << solverLevel << "won" << solverWon
+                             << "cancelled" << solverCancelled << "states"
+                             << solver->statesSearched()
+                             << "ms" << solver->elapsed();
+    solverProgress->hide();
+    solverProgress->deleteLater();
+    solverProgress = nullptr;
+    solverThread->deleteLater();
+    solverThread = nullptr;
+    delete solver;
+    solver = nullptr;
+    freeze (ProgramPause, false);
+
+    if (solverWon && (! solverCancelled)) {
+        // Save the solution, so that it need not be searched for again.
+        const QString solvedPrefix = gameList.at (solverGame)->prefix;
+        saveRecording (QStringLiteral("sol_"), solvedPrefix, solution);
+        setPlayback (true);		// Show the solution that was found.
+        startDemo (USER, solvedPrefix, solverLevel);
+    }
+    else if (! solverCancelled) {
+        noSolution();
     }
-    configGroup.writeEntry ("Draws", bytes);
+    delete solution;
+    solution = nullptr;
+}
 
-    configGroup.sync();			// Ensure that the entry goes to disk.
+void KGrGame::noSolution()
+{
+    KGrMessage::information (view, i18nc("@title:window", "Show a Solution"),
+        i18n ("Sorry, although all levels of KGoldrunner can be "
+              "solved, no solution has been recorded yet for the "
+              "level you selected."), QStringLiteral("Show_noSolutionRecorded"));
+}
+
+void KGrGame::saveRecording (const QString & filetype)
+{
+    saveRecording (filetype, prefix, recording);
+}
+
+void KGrGame::saveRecording (const QString & filetype, const QString & pPrefix,
+                             const KGrRecording * pRecording)
+{
+    QString textName = userDataDir + filetype + pPrefix + QStringLiteral(".txt");
+    QString filename = KGrRecordingIO::binaryName (textName);
+    QString groupName = pPrefix +
+                        QString::number(pRecording->level).rightJustified(3,QLatin1Char('0'));
+    //qCDebug(KGOLDRUNNER_LOG) << filename << groupName;
+
+    // Keep any recordings made by older versions, which used the text format.
+    // If they cannot be converted, add to the text file, because a new binary
+    // file would hide them (see getRecordingName()).
+    if ((! QFileInfo::exists (filename)) && QFileInfo::exists (textName) &&
+        (KGrRecordingIO::convert (textName, filename) < 0)) {
+        filename = textName;
+    }
+    if (! KGrRecordingIO::write (filename, groupName, pRecording)) {
+        qCWarning(KGOLDRUNNER_LOG) << "Could not save recording on" << filename;
+    }
 }
 
 bool KGrGame::loadRecording (const QString & dir, const QString & prefix,
@@ -2192,35 +2348,10 @@ bool KGrGame::loadRecording (const QString & dir, const QString & prefix,
     QString groupName = prefix + QString::number(levelNo).rightJustified(3,QLatin1Char('0'));
     qCDebug(KGOLDRUNNER_LOG) << "loadRecording" << filename << prefix << levelNo << groupName;
 
-    KConfig config (filename, KConfig::SimpleConfig);
-    if (! config.hasGroup (groupName)) {
-        qCDebug(KGOLDRUNNER_LOG) << "Group" << groupName << "NOT FOUND";
+    if (! KGrRecordingIO::read (filename, groupName, recording)) {
         return false;
     }
 
-    KConfigGroup configGroup    = config.group (groupName);
-    QString blank;
-    recording->dateTime         = configGroup.readEntry ("DateTime", "");
-    recording->owner            = (Owner)(configGroup.readEntry
-                                                        ("Owner", (int)(USER)));
-    recording->rules            = configGroup.readEntry ("Rules", (int)('T'));
-    recording->prefix           = configGroup.readEntry ("Prefix", "");
-    recording->gameName         = configGroup.readEntry ("GameName", blank);
-    recording->level            = configGroup.readEntry ("Level",  1);
-    recording->width            = configGroup.readEntry ("Width",  FIELDWIDTH);
-    recording->height           = configGroup.readEntry ("Height", FIELDHEIGHT);
-    recording->layout           = configGroup.readEntry ("Layout", QByteArray());
-    recording->levelName        = configGroup.readEntry ("Name",   blank);
-    recording->hint             = configGroup.readEntry ("Hint",   blank);
-    recording->digWhileFalling  = configGroup.readEntry ("DigWhileFalling",
-                                                             true);
-    recording->lives            = configGroup.readEntry ("Lives",  5);
-    recording->score            = configGroup.readEntry ("Score",  0);
-    recording->speed            = configGroup.readEntry ("Speed",  10);
-    recording->controlMode      = configGroup.readEntry ("Mode",   (int)MOUSE);
-    recording->keyOption        = configGroup.readEntry ("KeyOption",
-                                                                (int)CLICK_KEY);
-
     // If demoType is DEMO or SOLVE, get the TRANSLATED gameName, levelName and
     // hint from current data (other recordings have been translated already).
     // Also get the CURRENT setting of digWhileFalling for this game and level
@@ -2264,20 +2395,6 @@ bool KGrGame::loadRecording (const QString & dir, const QString & prefix,
         }
     }
 
-    QList<int> bytes = configGroup.readEntry ("Content", QList<int>());
-    int n  = bytes.count();
-    recording->content.fill (0, n + 1);
-    for (int i = 0; i < n; i++) {
-        recording->content [i] = bytes.at (i);
-    }
-
-    bytes.clear();
-    bytes = configGroup.readEntry ("Draws", QList<int>());
-    n  = bytes.count();
-    recording->draws.fill (0, n + 1);
-    for (int i = 0; i < n; i++) {
-        recording->draws [i] = bytes.at (i);
-    }
     return true;
 }
 
@@ -27,7 +27,10 @@ class KGrSounds;
 
 class KGrEditor;
 class KGrLevelPlayer;
+class KGrSolver;
+class QProgressDialog;
 class QRandomGenerator;
+class QThread;
 class QTimer;
 
 class KGrGame : public QObject
@@ -46,10 +49,6 @@ public:
 
     bool saveOK();			// Check if edits were saved.
 
-    // Flags to control author's debugging aids.
-    static bool bugFix;
-    static bool logging;
-
 public Q_SLOTS:
     void initGame();			// Do the game object's first painting.
 
@@ -90,12 +89,19 @@ private:
     void runNextDemoLevel();
     void finishDemo();
 
+private Q_SLOTS:
+    void cancelSolver();		// Solver's progress dialog: Cancel.
+    void solverFinished();		// Save and show a solution, if found.
+
 private Q_SLOTS:
     void interruptDemo();
+    void seekReplay (const int tick);		// Timeline clicked or dragged.
+    void showReplayProgress (const int tick);	// Move along the timeline.
 
 private:
     void startInstantReplay();
     void replayLastLevel();
+    void showReplayTimeline();
 
     void showHint();			// Show hint for current level.
 
@@ -200,6 +206,8 @@ private:
     QString                     playbackPrefix;	// File-prefix for current demo.
     int                         playbackIndex;	// Record-index for curr demo.
     int                         playbackMax;	// Max index for current demo.
+    int                         replayTicks;	// Length of a replay that can
+						// seek (see timeline) or 0.
 
     long			lives;		// Lives remaining.
     long			score;		// Current score.
@@ -210,6 +218,15 @@ private:
 
     QTimer *			dyingTimer;	// For pause when the hero dies.
 
+    KGrSolver *                 solver;		// Search for a solution, if any.
+    KGrRecording *              solution;	// The solution found, if any.
+    QThread *                   solverThread;	// Where the search runs.
+    QProgressDialog *           solverProgress;	// Shows the search and Cancel.
+    bool                        solverWon;	// True if a solution was found.
+    bool                        solverCancelled; // True if the user cancelled.
+    int                         solverGame;	// The game and level that are
+    int                         solverLevel;	// being solved.
+
     int				lgHighlight;	// Row selected in "loadGame()".
 
 /******************************************************************************/
@@ -238,6 +255,10 @@ private:
     bool initRecordingData (const Owner fileOwner, const QString & prefix,
                             const int levelNo, const bool pPlayback);
     void saveRecording     (const QString & filetype); // Type "rec_" or "sol_".
+    void saveRecording     (const QString & filetype, const QString & pPrefix,
+                            const KGrRecording * pRecording);
+    bool solveLevel        (const int selectedGame, const int selectedLevel);
+    void noSolution        ();
     bool loadRecording     (const QString & dir,   const QString & prefix,
                                                    const int levelNo);
     void loadSounds();
@@ -0,0 +1,253 @@
+/*
+    SPDX-FileCopyrightText: 2026 The KGoldrunner Developers
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#include "kgrgamecache.h"
+#include "kgoldrunner_debug.h"
+
+#include <QDataStream>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QMutex>
+#include <QSaveFile>
+#include <QStandardPaths>
+
+#include <KLocalizedString>
+
+// The file starts with a magic number and a version number.  If the layout of
+// the cache changes, the version must be changed, so that old caches are
+// ignored and rebuilt.
+static const quint32 CacheMagic   = 0x4b475243;		// "KGRC".
+static const quint32 CacheVersion = 1;
+
+/// The cached contents of one game-file.
+class KGrGameCacheEntry
+{
+public:
+    qint64                          size;
+    qint64                          modified;	// Milliseconds since epoch.
+    QList<KGrGameCache::Game>       games;
+    QHash<int, KGrGameCache::Level> levels;
+};
+
+namespace
+{
+QMutex                             cacheLock;
+QHash<QString, KGrGameCacheEntry>  cacheEntries;
+bool                               cacheLoaded = false;
+bool                               cacheDirty  = false;
+}
+
+bool KGrGameCache::findGames (const QString & filePath, const Owner o,
+                              QList<KGrGameData *> & gameList)
+{
+    QMutexLocker lock (&cacheLock);
+    const KGrGameCacheEntry * e = findEntry (filePath);
+    if (e == nullptr) {
+        return false;
+    }
+
+    for (const Game & game : e->games) {
+        KGrGameData * g = new KGrGameData;
+        g->owner    = o;
+        g->nLevels  = game.nLevels;
+        g->rules    = game.rules;
+        g->digWhileFalling = game.digWhileFalling;
+        g->prefix   = game.prefix;
+        g->skill    = game.skill;
+        g->width    = FIELDWIDTH;
+        g->height   = FIELDHEIGHT;
+        g->name     = game.name.isEmpty() ? QString() :
+                                            i18n (game.name.constData());
+        g->about    = game.about;
+        gameList.append (g);
+    }
+    return true;
+}
+
+bool KGrGameCache::findLevel (const QString & filePath, const int level,
+                              KGrLevelData & d)
+{
+    QMutexLocker lock (&cacheLock);
+    const KGrGameCacheEntry * e = findEntry (filePath);
+    if ((e == nullptr) || (! e->levels.contains (level))) {
+        return false;
+    }
+
+    const Level & l = e->levels [level];
+    d.level  = level;
+    d.width  = l.data.width;
+    d.height = l.data.height;
+    d.layout = l.data.layout;
+    d.name   = l.data.name;
+    d.hint   = l.data.hint;
+    if (l.dwfSet) {
+        d.digWhileFalling = l.data.digWhileFalling;
+    }
+    return true;
+}
+
+void KGrGameCache::store (const QString & filePath, const qint64 size,
+                          const QDateTime & modified,
+                          const QList<Game> & games,
+                          const QHash<int, Level> & levels)
+{
+    QMutexLocker lock (&cacheLock);
+    load();
+
+    KGrGameCacheEntry & e = cacheEntries [filePath];
+    e.size      = size;
+    e.modified  = modified.toMSecsSinceEpoch();
+    e.games     = games;
+    e.levels    = levels;
+    cacheDirty  = true;
+}
+
+void KGrGameCache::save()
+{
+    QMutexLocker lock (&cacheLock);
+    if (! cacheDirty) {
+        return;
+    }
+
+    // Drop the entries for game-files that have been deleted.
+    for (auto it = cacheEntries.begin(); it != cacheEntries.end(); ) {
+        if (QFileInfo::exists (it.key())) {
+            ++it;
+        }
+        else {
+            it = cacheEntries.erase (it);
+        }
+    }
+
+    QString filePath = cacheFilePath();
+    QDir().mkpath (QFileInfo (filePath).absolutePath());
+    QSaveFile file (filePath);
+    if (! file.open (QIODevice::WriteOnly)) {
+        qCWarning(KGOLDRUNNER_LOG) << "Cannot write game cache" << filePath;
+        return;
+    }
+
+    QDataStream out (&file);
+    out.setVersion (QDataStream::Qt_6_0);
+    out << CacheMagic << CacheVersion << quint32 (cacheEntries.size());
+    for (auto it = cacheEntries.cbegin(); it != cacheEntries.cend(); ++it) {
+        const KGrGameCacheEntry & e = it.value();
+        out << it.key() << e.size << e.modified;
+
+        out << quint32 (e.games.size());
+        for (const Game & g : e.games) {
+            out << qint32 (g.nLevels) << qint8 (g.rules) << g.prefix
+                << qint8 (g.skill) << g.digWhileFalling << g.name << g.about;
+        }
+
+        out << quint32 (e.levels.size());
+        for (auto l = e.levels.cbegin(); l != e.levels.cend(); ++l) {
+            const KGrLevelData & d = l.value().data;
+            out << qint32 (l.key()) << qint32 (d.width) << qint32 (d.height)
+                << d.layout << d.name << d.hint
+                << l.value().dwfSet << d.digWhileFalling;
+        }
+    }
+
+    if ((out.status() != QDataStream::Ok) || (! file.commit())) {
+        qCWarning(KGOLDRUNNER_LOG) << "Cannot write game cache" << filePath;
+        return;
+    }
+    cacheDirty = false;
+}
+
+const KGrGameCacheEntry * KGrGameCache::findEntry (const QString & filePath)
+{
+    // The caller must hold the lock.
+    load();
+
+    auto it = cacheEntries.constFind (filePath);
+    if (it == cacheEntries.constEnd()) {
+        return nullptr;
+    }
+
+    QFileInfo fileInfo (filePath);
+    if ((! fileInfo.exists()) || (fileInfo.size() != it->size) ||
+        (fileInfo.lastModified().toMSecsSinceEpoch() != it->modified)) {
+        return nullptr;			// The file has been changed or deleted.
+    }
+    return &(*it);
+}
+
+void KGrGameCache::load()
+{
+    // The caller must hold the lock.
+    if (cacheLoaded) {
+        return;
+    }
+    cacheLoaded = true;
+
+    QFile file (cacheFilePath());
+    if (! file.open (QIODevice::ReadOnly)) {
+        return;				// There is no cache yet.
+    }
+
+    QDataStream in (&file);
+    in.setVersion (QDataStream::Qt_6_0);
+    quint32 magic   = 0;
+    quint32 version = 0;
+    quint32 nFiles  = 0;
+    in >> magic >> version >> nFiles;
+    if ((magic != CacheMagic) || (version != CacheVersion)) {
+        return;				// Ignore and later replace the cache.
+    }
+
+    QHash<QString, KGrGameCacheEntry> entries;
+    for (quint32 f = 0; (f < nFiles) && (in.status() == QDataStream::Ok); f++) {
+        QString           filePath;
+        KGrGameCacheEntry e;
+        quint32 n = 0;
+        in >> filePath >> e.size >> e.modified;
+
+        in >> n;
+        for (quint32 i = 0; (i < n) && (in.status() == QDataStream::Ok); i++) {
+            Game   g;
+            qint32 nLevels = 0;
+            qint8  rules   = 0;
+            qint8  skill   = 0;
+            in >> nLevels >> rules >> g.prefix >> skill >> g.digWhileFalling
+               >> g.name >> g.about;
+            g.nLevels = nLevels;
+            g.rules   = rules;
+            g.skill   = skill;
+            e.games.append (g);
+        }
+
+        in >> n;
+        for (quint32 i = 0; (i < n) && (in.status() == QDataStream::Ok); i++) {
+            Level  l;
+            qint32 level  = 0;
+            qint32 width  = 0;
+            qint32 height = 0;
+            in >> level >> width >> height >> l.data.layout >> l.data.name
+               >> l.data.hint >> l.dwfSet >> l.data.digWhileFalling;
+            l.data.level  = level;
+            l.data.width  = width;
+            l.data.height = height;
+            e.levels.insert (level, l);
+        }
+        entries.insert (filePath, e);
+    }
+
+    if (in.status() != QDataStream::Ok) {
+        qCWarning(KGOLDRUNNER_LOG) << "Ignoring damaged game cache"
+                                   << file.fileName();
+        return;
+    }
+    cacheEntries = entries;
+}
+
+QString KGrGameCache::cacheFilePath()
+{
+    return QStandardPaths::writableLocation (QStandardPaths::CacheLocation) +
+           QStringLiteral("/gamefiles.cache");
+}
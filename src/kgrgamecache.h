@@ -0,0 +1,110 @@
+/*
+    SPDX-FileCopyrightText: 2026 The KGoldrunner Developers
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#ifndef KGRGAMECACHE_H
+#define KGRGAMECACHE_H
+
+#include "kgrglobals.h"
+
+#include <QDateTime>
+#include <QHash>
+#include <QList>
+
+class KGrGameCacheEntry;
+
+/**
+ * The KGrGameCache class keeps the parsed contents of game-files, so that
+ * KGrGameIO need not read and parse every game_*.txt file each time that
+ * KGoldrunner starts.  The cache is saved in a binary file in the user's
+ * cache directory (e.g. $HOME/.cache/kgoldrunner/gamefiles.cache) and is read
+ * once, when it is first needed.
+ *
+ * Each game-file has one entry, keyed by its path and checked against its size
+ * and modification time.  If the file has been changed, the entry is not used
+ * and KGrGameIO parses the file and stores a new entry.  The entry holds the
+ * data for the games on the file and, for KGoldrunner 3 files, the data for
+ * all of their levels.  Game names are stored untranslated and are translated
+ * when they are fetched, so the cache is not affected by changes of language.
+ *
+ * All the methods are static and thread-safe.
+ *
+ * @short   KGoldrunner Game-File Cache
+ */
+
+class KGrGameCache
+{
+public:
+    /// The data for one game, as it is on the game-file.
+    class Game
+    {
+    public:
+        int         nLevels;		///< Number of levels in the game.
+        char        rules;		///< Game's rules.
+        QString     prefix;		///< Game's filename prefix.
+        char        skill;		///< Game's skill.
+        bool        digWhileFalling;	///< If all levels allow it.
+        QByteArray  name;		///< Name of game (untranslated).
+        QByteArray  about;		///< Optional info about game.
+    };
+
+    /// The data for one level, as it is on the game-file.
+    class Level
+    {
+    public:
+        KGrLevelData data;		///< Layout, name, hint, etc.
+        bool         dwfSet;		///< If the level has a "dwf" option.
+    };
+
+    /**
+     * Find the games on a game-file, if the file has not been changed since
+     * they were stored.
+     *
+     * @param filePath   The game-file.
+     * @param o          The owner of the games (System or User).
+     * @param gameList   The list to which the games are appended.
+     *
+     * @return           True if the games were found in the cache.
+     */
+    static bool findGames (const QString & filePath, const Owner o,
+                           QList<KGrGameData *> & gameList);
+
+    /**
+     * Find the data for a level of a KGoldrunner 3 game-file, if the file has
+     * not been changed since the level was stored.  The "dig while falling"
+     * setting in d is changed only if the level has a "dwf" option.
+     *
+     * @return           True if the level was found in the cache.
+     */
+    static bool findLevel (const QString & filePath, const int level,
+                           KGrLevelData & d);
+
+    /**
+     * Store the contents of a game-file, replacing any previous entry.
+     *
+     * @param filePath   The game-file.
+     * @param size       The size of the file when it was parsed.
+     * @param modified   The modification time of the file when it was parsed.
+     * @param games      The games on the file.
+     * @param levels     The levels on the file, if in KGoldrunner 3 format.
+     */
+    static void store     (const QString & filePath, const qint64 size,
+                           const QDateTime & modified,
+                           const QList<Game> & games,
+                           const QHash<int, Level> & levels);
+
+    /**
+     * Write the cache to disk, if any entries have been stored since it was
+     * read.  Entries for files that no longer exist are dropped.
+     */
+    static void save();
+
+private:
+    static const KGrGameCacheEntry * findEntry (const QString & filePath);
+    static void          load();
+    static QString       cacheFilePath();
+};
+
+#endif // KGRGAMECACHE_H
@@ -6,16 +6,42 @@
 */
 
 #include "kgrgameio.h"
+#include "kgrgamecache.h"
 #include "kgoldrunner_debug.h"
 
+#include <QDateTime>
 #include <QDir>
+#include <QFileInfo>
+#include <QHash>
+#include <QMutex>
 #include <QWidget>
 
 #include <KLocalizedString>
 
+/**
+ * A game-file or level-file, mapped into memory (or read into a buffer if it
+ * cannot be mapped), with an index of the levels in a KGoldrunner 3 game-file.
+ */
+class KGrMappedFile
+{
+public:
+    QFile              file;		// Stays open while the map is in use.
+    QByteArray         buffer;		// Used only if mapping fails.
+    const char *       data = nullptr;
+    qint64             size = 0;
+    QDateTime          modified;	// Used to detect changes to the file.
+    QHash<int, qint64> levels;		// Offset of the line after "L<level>".
+};
+
+// The cache of mapped files, shared by all KGrGameIO objects.
+static QMutex                                         mappedFilesLock;
+static QHash<QString, QSharedPointer<KGrMappedFile> > mappedFiles;
+
 KGrGameIO::KGrGameIO (QWidget * pView)
     :
-    view        (pView)
+    view        (pView),
+    linePtr     (nullptr),
+    fileEnd     (nullptr)
 {
 }
 
@@ -41,25 +67,26 @@ IOStatus KGrGameIO::fetchGameListData
         }
 
         filePath = dir + filename;
+
+        // Use the parsed data from the cache, if the file has not changed.
+        if (KGrGameCache::findGames (filePath, o, gameList)) {
+            continue;
+        }
+
         KGrGameData * g = initGameData (o);
         gameList.append (g);
         // //qCDebug(KGOLDRUNNER_LOG)<< "GAME PATH:" << filePath;
 
-        openFile.setFileName (filePath);
-
-        // Check that the game-file exists.
-        if (! openFile.exists()) {
-            return (NotFound);
-        }
-
-        // Open the file for read-only.
-        if (! openFile.open (QIODevice::ReadOnly)) {
-            return (NoRead);
+        // Check that the game-file exists and map it for read-only.
+        IOStatus status = mapFile (filePath, kgr3Format);
+        if (status != OK) {
+            return (status);
         }
 
         char c;
         QByteArray textLine;
         QByteArray gameName;
+        QList<KGrGameCache::Game> cachedGames;
 
         // Find the first line of game-data.
         c = getALine (kgr3Format, textLine);
@@ -69,7 +96,7 @@ IOStatus KGrGameIO::fetchGameListData
             }
         }
         if (c == '\0') {
-            openFile.close();
+            unmapFile();
             return (UnexpectedEOF);	// We reached end-of-file unexpectedly.
         }
 
@@ -136,6 +163,9 @@ IOStatus KGrGameIO::fetchGameListData
             g->about = removeNewline (g->about);	// Remove final '\n'.
             // //qCDebug(KGOLDRUNNER_LOG) << "Info about: [" + g->about + "]";
 
+            cachedGames.append ({g->nLevels, g->rules, g->prefix, g->skill,
+                                 g->digWhileFalling, gameName, g->about});
+
             if ((! kgr3Format) && (c != '\0')) {
                 filePath = dir + filename;
                 g = initGameData (o);
@@ -143,10 +173,30 @@ IOStatus KGrGameIO::fetchGameListData
             }
         } // END: game-data loop
 
-        openFile.close();
+        // Parse all the levels of a KGr 3 game-file, for the cache.
+        QHash<int, KGrGameCache::Level> cachedLevels;
+        if (kgr3Format) {
+            const QList<int> levels = mappedFile->levels.keys();
+            for (const int level : levels) {
+                KGrGameCache::Level l;
+                l.data.level  = level;
+                l.data.width  = FIELDWIDTH;
+                l.data.height = FIELDHEIGHT;
+                l.data.digWhileFalling = g->digWhileFalling;
+                linePtr = mappedFile->data + mappedFile->levels.value (level);
+                if (readLevel (kgr3Format, l.data, l.dwfSet) == OK) {
+                    cachedLevels.insert (level, l);
+                }
+            }
+        }
+        KGrGameCache::store (filePath, mappedFile->size, mappedFile->modified,
+                             cachedGames, cachedLevels);
+
+        unmapFile();
 
     } // END: filename loop
 
+    KGrGameCache::save();
     return (OK);
 }
 
@@ -193,43 +243,61 @@ IOStatus KGrGameIO::fetchLevelData
     d.hint   = "";		// Level hint (optional).
 
     // //qCDebug(KGOLDRUNNER_LOG)<< "LEVEL PATH:" << filePath;
-    openFile.setFileName (filePath);
 
-    // Check that the level-file exists.
-    if (! openFile.exists()) {
-        return (NotFound);
-    }
+    // Determine whether the file is in KGoldrunner v3 or v2 format.
+    bool kgr3Format = (filePath.endsWith (QLatin1String(".txt")));
 
-    // Open the file for read-only.
-    if (! openFile.open (QIODevice::ReadOnly)) {
-        return (NoRead);
+    // Use the parsed data from the cache, if the file has not changed.
+    if (kgr3Format && KGrGameCache::findLevel (filePath, level, d)) {
+        return (OK);
     }
 
-    char c;
-    QByteArray textLine;
-    IOStatus result = UnexpectedEOF;
-
-    // Determine whether the file is in KGoldrunner v3 or v2 format.
-    bool kgr3Format = (filePath.endsWith (QLatin1String(".txt")));
+    // Check that the level-file exists and map it for read-only.
+    IOStatus result = mapFile (filePath, kgr3Format);
+    if (result != OK) {
+        return (result);
+    }
 
     if (kgr3Format) {
-        // In KGr 3 format, if a line starts with 'L', check the number.
-        while ((c = getALine (kgr3Format, textLine)) != '\0') {
-            if ((c == 'L') && (textLine.left (3).toInt() == level)) {
-                break;			// We have found the required level.
-            }
-        }
-        if (c == '\0') {
-            openFile.close();		// We reached end-of-file.
+        // In KGr 3 format, go straight to the line after "L<level>".
+        qint64 offset = mappedFile->levels.value (level, -1);
+        if (offset < 0) {
+            unmapFile();		// There is no such level on the file.
             return (UnexpectedEOF);
         }
+        linePtr = mappedFile->data + offset;
     }  
 
+    bool dwfSet = false;
+    result = readLevel (kgr3Format, d, dwfSet);
+    unmapFile();
+    return (result);
+}
+
+IOStatus KGrGameIO::readLevel (const bool kgr3Format, KGrLevelData & d,
+                               bool & dwfSet)
+{
+    char c;
+    QByteArray textLine;
+    IOStatus result = UnexpectedEOF;
+    dwfSet = false;
+
     // Check for further settings in this level.
     while ((c = getALine (kgr3Format, textLine)) == '.') {
         if (textLine.startsWith ("dwf ")) {
             // Dig while falling is allowed in this level, or not.
             d.digWhileFalling = textLine.endsWith (" false\n") ? false : true;
+            dwfSet = true;
+        }
+        else if (textLine.startsWith ("size ")) {
+            // The level is not the standard size: get its width and height.
+            QList<QByteArray> fields = removeNewline (textLine).split (' ');
+            int w = (fields.count() == 3) ? fields.at (1).toInt() : 0;
+            int h = (fields.count() == 3) ? fields.at (2).toInt() : 0;
+            if ((w > 0) && (h > 0)) {
+                d.width  = w;
+                d.height = h;
+            }
         }
     }
 
@@ -254,10 +322,80 @@ IOStatus KGrGameIO::fetchLevelData
     // //qCDebug(KGOLDRUNNER_LOG) << "Name:" << "[" + d.name + "]";
     // //qCDebug(KGOLDRUNNER_LOG) << "Hint:" << "[" + d.hint + "]";
 
-    openFile.close();
     return (result);
 }
 
+IOStatus KGrGameIO::mapFile (const QString & filePath, const bool kgr3)
+{
+    QFileInfo fileInfo (filePath);
+    if (! fileInfo.exists()) {
+        return (NotFound);
+    }
+
+    QMutexLocker lock (&mappedFilesLock);
+    QSharedPointer<KGrMappedFile> f = mappedFiles.value (filePath);
+    if (f.isNull() || (f->size != fileInfo.size()) ||
+        (f->modified != fileInfo.lastModified())) {
+        // Map the file, or re-map it if it has changed since it was mapped.
+        f.reset (new KGrMappedFile);
+        f->file.setFileName (filePath);
+        if (! f->file.open (QIODevice::ReadOnly)) {
+            mappedFiles.remove (filePath);
+            return (NoRead);
+        }
+        f->size     = f->file.size();
+        f->modified = fileInfo.lastModified();
+        if (f->size > 0) {
+            f->data = reinterpret_cast<const char *>
+                                        (f->file.map (0, f->size));
+            if (f->data == nullptr) {
+                // Some file systems cannot map files, so read the data.
+                f->buffer = f->file.readAll();
+                f->file.close();
+                f->data = f->buffer.constData();
+                f->size = f->buffer.size();
+            }
+        }
+
+        if (kgr3) {
+            // Index the "L" lines.  If a level occurs twice, use the first.
+            QByteArray textLine;
+            char       c;
+            linePtr = f->data;
+            fileEnd = f->data + f->size;
+            while ((c = getALine (kgr3, textLine)) != '\0') {
+                if (c == 'L') {
+                    int level = textLine.left (3).toInt();
+                    if (! f->levels.contains (level)) {
+                        f->levels.insert (level, linePtr - f->data);
+                    }
+                }
+            }
+        }
+        mappedFiles.insert (filePath, f);
+    }
+
+    mappedFile = f;
+    linePtr    = f->data;
+    fileEnd    = f->data + f->size;
+    return (OK);
+}
+
+void KGrGameIO::unmapFile()
+{
+    // The map stays in the cache, for the next time the file is read.
+    mappedFile.reset();
+    linePtr = nullptr;
+    fileEnd = nullptr;
+}
+
+void KGrGameIO::releaseFile (const QString & filePath)
+{
+    // Close and unmap the file, so that it can be renamed or deleted.
+    QMutexLocker lock (&mappedFilesLock);
+    mappedFiles.remove (filePath);
+}
+
 QString KGrGameIO::getFilePath
         (const QString & dir, const QString & prefix, const int level)
 {
@@ -286,13 +424,13 @@ QString KGrGameIO::getFilePath
 char KGrGameIO::getALine (const bool kgr3, QByteArray & line)
 {
     char c;
-    line = "";
-    while (openFile.getChar (&c)) {
-        line.append (c);
-        if (c == '\n') {
+    const char * start = linePtr;
+    while (linePtr < fileEnd) {
+        if (*linePtr++ == '\n') {
             break;
         }
     }
+    line = QByteArray (start, linePtr - start);
 
     // //qCDebug(KGOLDRUNNER_LOG) << "Raw line:" << line;
     if (line.size() <= 0) {
@@ -371,6 +509,9 @@ KGrGameData * KGrGameIO::initGameData (Owner o)
 bool KGrGameIO::safeRename (QWidget * theView, const QString & oldName,
                             const QString & newName)
 {
+    releaseFile (oldName);
+    releaseFile (newName);
+
     QFile newFile (newName);
     if (newFile.exists()) {
         // On some file systems we cannot rename if a file with the new name
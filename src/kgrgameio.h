@@ -11,8 +11,10 @@
 #include "kgrglobals.h"
 
 #include <QFile>
+#include <QSharedPointer>
 
 class QWidget;
+class KGrMappedFile;
 
 /// Return values from I/O operations.
 enum IOStatus {OK, NotFound, NoRead, NoWrite, UnexpectedEOF};
@@ -37,6 +39,18 @@ enum IOStatus {OK, NotFound, NoRead, NoWrite, UnexpectedEOF};
  * " " = level data, with line 1 being the layout codes, line 2 (optional) the
  * level name and lines >2 (optional) the hint. 
  * 
+ * In either format, lines starting with "." set options for a game or level,
+ * such as ".dwf false" (no digging while falling) and ".size 64 40" (a level
+ * that is not the standard 28 x 20 cells).  The layout of a level has one
+ * character per cell, row by row.
+ * 
+ * Files are read by mapping them into memory, not by reading them a character
+ * at a time.  Each mapped file is kept in a cache that is shared by all
+ * KGrGameIO objects, until the file is changed, renamed or deleted.  When a
+ * KGoldrunner 3 file is mapped, an index is made of the offsets of its "L"
+ * lines, so that the data for any level can be found without parsing the
+ * levels before it.
+ * 
  * This class is used by the game and its editor and is also used by a utility
  * program that finds game names, level names and hints and rewrites them in
  * a format suitable for extracting strings that KDE translators can use.
@@ -82,10 +96,24 @@ public:
     static bool safeRename (QWidget * theView, const QString & oldName,
                             const QString & newName);
 
+    /**
+     * Drop a file from the cache of mapped files, so that it can be written,
+     * renamed or deleted.  Must be called before changing a game or level file
+     * in any way other than safeRename().
+     */
+    static void releaseFile (const QString & filePath);
+
 private:
     QWidget *           view;
 
-    QFile		openFile;
+    QSharedPointer<KGrMappedFile> mappedFile;	// The file being read.
+    const char *	linePtr;		// Start of the next line.
+    const char *	fileEnd;		// End of the file.
+
+    IOStatus		mapFile (const QString & filePath, const bool kgr3);
+    void		unmapFile();
+    IOStatus		readLevel (const bool kgr3Format, KGrLevelData & d,
+                                   bool & dwfSet);
 
     QString		getFilePath (const QString & dir,
                                 const QString & prefix, const int level);
@@ -125,8 +125,18 @@ public:
     int            keyOption;  	///< Click/hold option for keyboard mode.
     QByteArray     content;	///< The encoded recording of play.
     QByteArray     draws;	///< The random numbers used during play.
+    quint64        seed;	///< Seed of the random numbers (see KGrRandom),
+				///< or 0 if they are kept in draws.
+    QByteArray     checks;	///< A checksum of the state after each tick
+				///< (none in older recordings).
 };
 
+// The version of the state checksums in KGrRecording::checks.  Increase it
+// whenever KGrLevelPlayer::stateChecksum() changes.  Checksums of any other
+// version, including those written before there was a version, are dropped
+// when a recording is read, so they are not compared with new checksums.
+const int ChecksVersion = 2;
+
 // Offsets used to encode keystrokes, control modes and speeds in a recording.
 // Allow space for 16 direction and digging codes, 12 control modes, 4 keyboard
 // click/hold option codes, 16 special actions and 30 speeds.  We actually have
@@ -141,6 +151,11 @@ public:
 #define SPEED_CODE     0xe0
 #define END_CODE       0xff
 
+// A pointer position with I or J above 127 (in a level that is wider or higher
+// than 127 cells), which cannot be recorded in the usual two bytes.  It is
+// followed by four bytes of position and a repetition count.
+#define TARGET_CODE    0xd0
+
 enum GameAction    {NEW, NEXT_LEVEL, LOAD, SAVE_GAME, PAUSE, HIGH_SCORE,
                     KILL_HERO, HINT,
                     DEMO, SOLVE, SAVE_SOLUTION,
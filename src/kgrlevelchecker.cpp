@@ -0,0 +1,263 @@
+/*
+    SPDX-FileCopyrightText: 2026 The KGoldrunner Developers
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#include "kgrlevelchecker.h"
+#include "kgrlevelgrid.h"
+
+#include <QMetaObject>
+#include <QMutexLocker>
+#include <QRunnable>
+
+/// A check on the worker thread, which goes on checking until no layout is
+/// waiting.
+class KGrLevelChecker::Task : public QRunnable
+{
+public:
+    explicit Task (KGrLevelChecker * pChecker) : checker (pChecker) {}
+
+    void run() override;
+
+private:
+    KGrLevelChecker * checker;
+};
+
+/**
+ * Find the hero's moves from cell (i, j).  A brick is taken to be a hole that
+ * the hero has dug and dropped into: he can stand in it, if there is something
+ * under it to stand on, and go left or right from it, or else he falls.
+ */
+static Flags movesAt (KGrLevelGrid * grid, const int i, const int j)
+{
+    if (grid->cellType (i, j) != BRICK) {
+        return grid->heroMoves (i, j);
+    }
+    char  below = grid->cellType (i, j + 1);
+    Flags moves = 0;
+    if ((below == BRICK) || (below == CONCRETE) || (below == USEDHOLE) ||
+        (below == LADDER)) {
+        moves = dFlag [STAND];
+        if (grid->heroMoves (i - 1, j) & ENTERABLE) {
+            moves |= dFlag [LEFT];
+        }
+        if (grid->heroMoves (i + 1, j) & ENTERABLE) {
+            moves |= dFlag [RIGHT];
+        }
+    }
+    else if ((grid->heroMoves (i, j + 1) & ENTERABLE) || (below == FBRICK)) {
+        moves = dFlag [DOWN];
+    }
+    return moves;
+}
+
+void KGrLevelChecker::Task::run()
+{
+    KGrLevelData level;
+    int          generation;
+    while (true) {
+        {
+            QMutexLocker locker (&checker->lock);
+            if (! checker->nextWaiting) {
+                checker->running = false;
+                return;
+            }
+            level                = checker->next;
+            generation           = checker->generation;
+            checker->nextWaiting = false;
+        }
+
+        QList<int> lostGold;
+        bool       exitOK = checkLayout (level, lostGold);
+
+        // Report on the checker's thread, if no other layout has been sent.
+        KGrLevelChecker * c = checker;
+        QMetaObject::invokeMethod (c, [c, generation, lostGold, exitOK] () {
+                bool latest;
+                {
+                    QMutexLocker locker (&c->lock);
+                    latest = (generation == c->generation);
+                }
+                if (latest) {
+                    Q_EMIT c->checked (lostGold, exitOK);
+                }
+            }, Qt::QueuedConnection);
+    }
+}
+
+KGrLevelChecker::KGrLevelChecker (QObject * parent)
+    :
+    QObject     (parent),
+    nextWaiting (false),
+    running     (false),
+    generation  (0)
+{
+    pool.setMaxThreadCount (1);
+}
+
+KGrLevelChecker::~KGrLevelChecker()
+{
+    {
+        QMutexLocker locker (&lock);
+        nextWaiting = false;		// Stop after the current check.
+    }
+    pool.waitForDone();
+}
+
+void KGrLevelChecker::check (const KGrLevelData & level)
+{
+    QMutexLocker locker (&lock);
+    next        = level;
+    nextWaiting = true;
+    generation++;
+    if (! running) {
+        running = true;
+        pool.start (new Task (this));
+    }
+}
+
+bool KGrLevelChecker::checkLayout (const KGrLevelData & level,
+                                   QList<int> & lostGold)
+{
+    lostGold.clear();
+
+    // The hero and enemies start in cells that are otherwise empty.
+    KGrRecording layout;
+    layout.width  = level.width;
+    layout.height = level.height;
+    layout.layout = level.layout;
+    int heroCell  = -1;
+    for (int n = 0; n < layout.layout.size(); n++) {
+        char type = layout.layout.at (n);
+        if (type == HERO) {
+            heroCell = n;
+        }
+        if ((type == HERO) || (type == ENEMY)) {
+            layout.layout [n] = FREE;
+        }
+    }
+    if (heroCell < 0) {
+        return true;			// Nothing to check until there is a hero.
+    }
+
+    // The rule for running through holes affects only the enemies.
+    KGrLevelGrid grid (nullptr, &layout);
+    grid.calculateAccess (false);
+
+    const int   width  = grid.gridWidth();
+    const int   height = grid.levelHeight() + 2 * ConcreteWall;
+    const int   hero   = (heroCell % level.width + ConcreteWall) +
+                         (heroCell / level.width + ConcreteWall) * width;
+    QList<bool> reached;
+    QList<int>  queue;
+
+    reached.fill (false, width * height);
+
+    reached [hero] = true;
+    queue.append (hero);
+    search (&grid, reached, queue, level.digWhileFalling);
+
+    // Any piece of gold that can be reached could be the last one collected.
+    QList<int> gold;
+    for (int j = 1; j < height - 1; j++) {
+        for (int i = 1; i < width - 1; i++) {
+            if (grid.cellType (i, j) != NUGGET) {
+                continue;
+            }
+            if (reached.at (i + j * width)) {
+                gold.append (i + j * width);
+            }
+            else {
+                lostGold.append ((i - 1) + (j - 1) * level.width);
+            }
+        }
+    }
+    if (gold.isEmpty()) {
+        gold.append (hero);
+    }
+
+    // The hidden ladders appear when the last piece of gold is collected.
+    grid.placeHiddenLadders();
+    reached.fill (false);
+    queue.clear();
+    for (const int position : std::as_const(gold)) {
+        reached [position] = true;
+        queue.append (position);
+    }
+    search (&grid, reached, queue, level.digWhileFalling);
+
+    for (int i = 1; i < width - 1; i++) {
+        if (reached.at (i + width) && (movesAt (&grid, i, 1) & dFlag [STAND])) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * Find if a hero can dig the brick under cell (i, j) and drop into the hole.
+ * Cell (i, j) must be clear: a brick that has been dug out or gold that has
+ * been collected is clear once the hero has reached it.
+ */
+static bool canDig (KGrLevelGrid * grid, const QList<bool> & reached,
+                    const int i, const int j)
+{
+    char above = grid->cellType (i, j);
+    return (grid->cellType (i, j + 1) == BRICK) &&
+           ((above == FREE) || (above == HOLE) ||
+            (((above == BRICK) || (above == NUGGET)) &&
+             reached.at (i + j * grid->gridWidth())));
+}
+
+void KGrLevelChecker::search (KGrLevelGrid * grid, QList<bool> & reached,
+                              QList<int> & queue, const bool digWhileFalling)
+{
+    const int       width       = grid->gridWidth();
+    const Direction ways [4]    = {LEFT, RIGHT, UP, DOWN};
+    const int       digSide [2] = {-1, +1};
+
+    for (int n = 0; n < queue.count(); n++) {
+        int   position = queue.at (n);
+        int   i        = position % width;
+        int   j        = position / width;
+        Flags moves    = movesAt (grid, i, j);
+        bool  stand    = (moves & dFlag [STAND]);
+        int   next [8];			// The cells that can be reached next.
+        int   count    = 0;
+
+        // A runner that cannot stand can only fall.
+        for (const Direction dirn : ways) {
+            if ((moves & dFlag [dirn]) && (stand || (dirn == DOWN))) {
+                next [count++] = (i + movement [dirn][X]) +
+                                 (j + movement [dirn][Y]) * width;
+            }
+        }
+
+        // A brick can be dug out beside and below, if the cell above it is
+        // clear, and the hero can then drop into the hole.  This cell may have
+        // become clear just now, so a hero standing beside it can dig too.  If
+        // the hero digs while falling, he can come back to the hole later.
+        for (const int d : digSide) {
+            if ((stand || digWhileFalling) &&
+                canDig (grid, reached, i + d, j)) {
+                next [count++] = (i + d) + (j + 1) * width;
+            }
+            if (reached.at (position - d) &&
+                (movesAt (grid, i - d, j) & dFlag [STAND]) &&
+                canDig (grid, reached, i, j)) {
+                next [count++] = i + (j + 1) * width;
+            }
+        }
+
+        for (int k = 0; k < count; k++) {
+            int to = next [k];
+            if (! reached.at (to)) {
+                reached [to] = true;
+                queue.append (to);
+            }
+        }
+    }
+}
+
+#include "moc_kgrlevelchecker.cpp"
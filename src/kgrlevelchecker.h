@@ -0,0 +1,101 @@
+/*
+    SPDX-FileCopyrightText: 2026 The KGoldrunner Developers
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#ifndef KGRLEVELCHECKER_H
+#define KGRLEVELCHECKER_H
+
+#include "kgrglobals.h"
+
+#include <QList>
+#include <QMutex>
+#include <QObject>
+#include <QThreadPool>
+
+class KGrLevelGrid;
+
+/**
+ * The KGrLevelChecker class finds out, while a level is being edited, which
+ * pieces of gold the hero cannot reach and whether he can reach the top row
+ * (the exit) once all the gold has been collected and the hidden ladders
+ * have appeared.  KGrEditor asks for a check after each change to the layout
+ * and shows the results as warnings on the scene.
+ *
+ * The check builds a KGrLevelGrid of the layout, with its access flags, and
+ * searches forwards from the hero's cell, cell by cell, using the hero's moves
+ * (see KGrLevelGrid::heroMoves()).  A brick that the hero can dig is treated
+ * as a hole he can drop into, which stays open for as long as he needs it.
+ * Enemies are ignored, so a warning can be wrong for a level that has to be
+ * solved by standing on an enemy's head or by letting an enemy carry gold
+ * down.  Then the hidden ladders are placed and the search goes on from each
+ * piece of gold that can be reached, any of which could be the last one
+ * collected.
+ *
+ * Each check takes time in proportion to the number of cells and runs on a
+ * worker thread, so that editing is never held up.  Layouts sent while a
+ * check is running are not queued: only the latest one is checked next, and
+ * results that are out of date by then are not reported.
+ *
+ * @short   KGoldrunner Level Checker
+ */
+
+class KGrLevelChecker : public QObject
+{
+    Q_OBJECT
+public:
+    explicit KGrLevelChecker (QObject * parent = nullptr);
+    ~KGrLevelChecker() override;
+
+    /**
+     * Check a layout on the worker thread.  The checked() signal is emitted
+     * when the check is done, unless another layout has been sent by then.
+     *
+     * @param level      The level, with its width, height, layout and
+     *                   dig-while-falling rule.
+     */
+    void check (const KGrLevelData & level);
+
+    /**
+     * Check a layout at once, on this thread.
+     *
+     * @param level      The level, with its width, height, layout and
+     *                   dig-while-falling rule.
+     * @param lostGold   The cells of the gold that the hero cannot reach, as
+     *                   offsets in the layout (i - 1 + (j - 1) * width).
+     *
+     * @return           True if the hero can reach the top row after
+     *                   collecting the gold, or if there is no hero yet.
+     */
+    static bool checkLayout (const KGrLevelData & level,
+                             QList<int> & lostGold);
+
+Q_SIGNALS:
+    /**
+     * The results of the latest check.
+     *
+     * @param lostGold   The cells of the gold that the hero cannot reach, as
+     *                   offsets in the layout (i - 1 + (j - 1) * width).
+     * @param exitOK     True if the hero can reach the top row after
+     *                   collecting the gold.
+     */
+    void checked (const QList<int> & lostGold, const bool exitOK);
+
+private:
+    class Task;
+
+    // Mark the cells that the hero can reach from the cells already marked
+    // and listed in the queue, in the grid as it is.
+    static void search (KGrLevelGrid * grid, QList<bool> & reached,
+                        QList<int> & queue, const bool digWhileFalling);
+
+    QThreadPool  pool;			// One thread, for the checks.
+    QMutex       lock;
+    KGrLevelData next;			// The layout to be checked next.
+    bool         nextWaiting;		// True if "next" has not been taken.
+    bool         running;		// True while a task is checking.
+    int          generation;		// Number of layouts sent so far.
+};
+
+#endif // KGRLEVELCHECKER_H
@@ -5,10 +5,14 @@
 */
 
 #include "kgrlevelgrid.h"
+#include "kgrbitboard.h"
 
 KGrLevelGrid::KGrLevelGrid (QObject * parent, const KGrRecording * theLevelData)
     :
-    QObject     (parent)
+    QObject     (parent),
+    changeCounter (0),
+    hash        (0),
+    nav         (this)
 {
     // Put a concrete wall all round the layout: left, right, top and bottom.
     // This saves ever having to test for being at the edge of the layout.
@@ -26,14 +30,18 @@ KGrLevelGrid::KGrLevelGrid (QObject * parent, const KGrRecording * theLevelData)
     heroAccess.fill  (0, size);
     enemyAccess.fill (0, size);
     enemyHere.fill   (-1, size);
+    changed.fill     (false, size);
 
     // Copy the cells of the layout, but enclosed within the concrete wall.
+    // If the layout is too short for the width and height, pad it with FREE.
     int inRow  = 0;
     int outRow = width + ConcreteWall;
+    int inSize = theLevelData->layout.size();
 
     for (int j = 0; j < inHeight; j++) {
         for (int i = 0; i < inWidth; i++) {
-            char type = theLevelData->layout [inRow + i];
+            char type = (inRow + i < inSize) ?
+                        theLevelData->layout [inRow + i] : FREE;
             switch (type) {
             case HLADDER:
                 // Change hidden ladders to FREE, but keep a list of them.
@@ -56,6 +64,12 @@ KGrLevelGrid::KGrLevelGrid (QObject * parent, const KGrRecording * theLevelData)
         inRow  = inRow  + inWidth;
         outRow = outRow + width;
     }
+
+    for (int n = 0; n < size; n++) {
+        hash ^= KGrZobrist::key (KGrZobrist::Cell, n, layout.at (n));
+    }
+
+    nav.build();
 }
 
 KGrLevelGrid::~KGrLevelGrid()
@@ -72,39 +86,119 @@ KGrLevelGrid::~KGrLevelGrid()
 //     int enemyOccupied (int i, int j)
 //
 //     int  index      (int i, int j)
+//     void markChanged (const int position)
+
+// Reduce a cell-type to the types that calculateCellAccess() distinguishes.
+// Changing a cell within the same class (e.g. NUGGET to FREE) cannot change
+// the access flags of the cell or its neighbours.
+static char accessClass (const char type)
+{
+    switch (type) {
+    case BRICK:
+    case CONCRETE:
+    case FBRICK:
+    case USEDHOLE:
+    case HOLE:
+    case LADDER:
+    case BAR:
+        return type;
+    default:
+        return FREE;
+    }
+}
 
 void KGrLevelGrid::calculateAccess (bool pRunThruHole)
 {
     runThruHole = pRunThruHole;		// Save a copy of the runThruHole rule.
 
-    char here;
-    bool canEnter;
+    // Apply the rules of calculateCellAccess() to 64 cells at a time, using
+    // bit-planes of the cell-types and shifts to line up the cells at left
+    // and right.  The results must be the same, cell by cell.
+    typedef KGrBitBoard::Word Word;
+    KGrBitBoard board;
+    board.build (layout, width, height);
 
-    // Calculate which cells can be entered (N.B. USEDHOLE is a trapped enemy).
-    for (int j = 1; j < height - 1; j++) {
-        for (int i = 1; i < width - 1; i++) {
-            here      = cellType (i, j);
-            canEnter  = (here != BRICK)  && (here != CONCRETE) &&
-                        (here != FBRICK) && (here != USEDHOLE);
-            heroAccess  [index (i, j)] = canEnter ? ENTERABLE : 0;
-            enemyAccess [index (i, j)] = canEnter ? ENTERABLE : 0;
-        }
-    }
+    const int  words    = board.wordsPerRow();
+    const Word holeMask = runThruHole ? 0 : ~Word (0);
+
+    heroAccess.fill  (0, width * height);
+    enemyAccess.fill (0, width * height);
 
-    // Calculate the access *from* each cell to its neighbours.
     for (int j = 1; j < height - 1; j++) {
-        for (int i = 1; i < width - 1; i++) {
-            calculateCellAccess (i, j);
+        const Word * enter      = board.row (KGrBitBoard::Enterable,  j);
+        const Word * falseBrick = board.row (KGrBitBoard::FalseBrick, j);
+        const Word * usedHole   = board.row (KGrBitBoard::UsedHole,   j);
+        const Word * hole       = board.row (KGrBitBoard::Hole,       j);
+        const Word * ladder     = board.row (KGrBitBoard::Ladder,     j);
+        const Word * bar        = board.row (KGrBitBoard::Bar,        j);
+        const Word * enterAbove = board.row (KGrBitBoard::Enterable,  j - 1);
+        const Word * enterBelow = board.row (KGrBitBoard::Enterable,  j + 1);
+        const Word * fallBelow  = board.row (KGrBitBoard::FalseBrick, j + 1);
+        const Word * standBelow = board.row (KGrBitBoard::Support,    j + 1);
+        Flags *      hero       = heroAccess.data()  + j * width;
+        Flags *      enemy      = enemyAccess.data() + j * width;
+
+        for (int k = 0; k < words; k++) {
+            // A runner can be in an enterable cell or fall into a false brick.
+            Word in    = enter [k] | falseBrick [k];
+            Word stand = in & (standBelow [k] | ladder [k] | bar [k]);
+            Word down  = in & (enterBelow [k] | fallBelow [k]);
+            Word left  = in & KGrBitBoard::leftOf  (enter, k);
+            Word right = in & KGrBitBoard::rightOf (enter, k, words);
+            Word up    = in & ladder [k] & enterAbove [k];
+
+            // Enemies cannot run into holes at L/R, unless the rules allow.
+            Word enemyL = left  & ~(holeMask & KGrBitBoard::leftOf  (hole, k));
+            Word enemyR = right & ~(holeMask &
+                                    KGrBitBoard::rightOf (hole, k, words));
+
+            int first = k * KGrBitBoard::WordBits;
+            int count = qMin (width - first, KGrBitBoard::WordBits);
+            for (int b = 0; b < count; b++) {
+                Word bits =
+                    (((enter [k] >> b) & 1) * (Word) ENTERABLE)     |
+                    (((stand     >> b) & 1) * (Word) dFlag [STAND]) |
+                    (((down      >> b) & 1) * (Word) dFlag [DOWN])  |
+                    (((up        >> b) & 1) * (Word) dFlag [UP]);
+                Word enemyBits = bits |
+                    (((enemyL    >> b) & 1) * (Word) dFlag [LEFT])  |
+                    (((enemyR    >> b) & 1) * (Word) dFlag [RIGHT]);
+                bits |= (((left  >> b) & 1) * (Word) dFlag [LEFT])  |
+                        (((right >> b) & 1) * (Word) dFlag [RIGHT]);
+
+                // An enemy trapped in a hole can only climb out.
+                Word trapped = (usedHole [k] >> b) & 1;
+                hero  [first + b] = (Flags) bits;
+                enemy [first + b] = (Flags) ((enemyBits & (trapped - 1)) |
+                                             (trapped * (Word) UP));
+            }
         }
     }
+
+    // The whole grid is new, so there is no list of changes yet.
+    changed.fill (false, width * height);
+    changes.clear();
+    changeCounter++;
 }
 
 void KGrLevelGrid::changeCellAt (const int i, const int j, const char type)
 {
     int  position          = index (i, j);
+    char oldType           = layout [position];
+    if (type == oldType) {
+        return;
+    }
+    hash ^= KGrZobrist::key (KGrZobrist::Cell, position, oldType)
+          ^ KGrZobrist::key (KGrZobrist::Cell, position, type);
+    layout      [position] = type;
+    markChanged (position);
+    nav.cellChanged (i, j);
+    if (accessClass (type) == accessClass (oldType)) {
+        return;				// No access flags can change.
+    }
+
     bool canEnter          = (type != BRICK) && (type != CONCRETE) &&
                              (type != FBRICK) && (type != USEDHOLE);
-    layout      [position] = type;
     heroAccess  [position] = canEnter ? ENTERABLE : 0;
     enemyAccess [position] = canEnter ? ENTERABLE : 0;
 
@@ -167,19 +261,25 @@ void KGrLevelGrid::calculateCellAccess (const int i, const int j)
         }
     }
 
-    heroAccess [index (i, j)]  = access;
-    
     // Enemy access is the same as the hero's when no holes are open.
-    enemyAccess [index (i, j)] = heroAccess [index (i, j)];
+    Flags enemyAccessHere = access;
 
     if (here == USEDHOLE) {
-        enemyAccess [index (i, j)] = UP;	// Can only climb out of hole.
+        enemyAccessHere = UP;			// Can only climb out of hole.
     }
     else if (! runThruHole) {			// Check the rule.
         char mask;
         mask = (cellType (i - 1, j) == HOLE) ? dFlag [LEFT] : 0;
         mask = (cellType (i + 1, j) == HOLE) ? (dFlag [RIGHT] | mask) : mask;
-        enemyAccess [index (i, j)] &= ~mask;	// Block access to holes at L/R.
+        enemyAccessHere &= ~mask;		// Block access to holes at L/R.
+    }
+
+    int position = index (i, j);
+    if ((heroAccess [position] != access) ||
+        (enemyAccess [position] != enemyAccessHere)) {
+        heroAccess  [position] = access;
+        enemyAccess [position] = enemyAccessHere;
+        markChanged (position);
     }
 }
 
@@ -194,4 +294,44 @@ void KGrLevelGrid::placeHiddenLadders()
     hiddenLadders.clear();
 }
 
+void KGrLevelGrid::saveState (State & s) const
+{
+    s.layout        = layout;
+    s.heroAccess    = heroAccess;
+    s.enemyAccess   = enemyAccess;
+    s.enemyHere     = enemyHere;
+    s.hiddenLadders = hiddenLadders;
+    s.nav           = nav;
+    s.hash          = hash;
+}
+
+void KGrLevelGrid::restoreState (const State & s)
+{
+    int size = layout.count();
+    for (int n = 0; n < size; n++) {
+        if ((layout.at (n) != s.layout.at (n)) ||
+            (heroAccess.at (n) != s.heroAccess.at (n)) ||
+            (enemyAccess.at (n) != s.enemyAccess.at (n))) {
+            markChanged (n);
+        }
+    }
+    layout        = s.layout;
+    heroAccess    = s.heroAccess;
+    enemyAccess   = s.enemyAccess;
+    enemyHere     = s.enemyHere;
+    hiddenLadders = s.hiddenLadders;
+    nav           = s.nav;
+    hash          = s.hash;
+}
+
+QList<int> KGrLevelGrid::takeChanges()
+{
+    for (const int position : std::as_const(changes)) {
+        changed [position] = false;
+    }
+    QList<int> result;
+    result.swap (changes);
+    return result;
+}
+
 #include "moc_kgrlevelgrid.cpp"
@@ -8,6 +8,8 @@
 #define KGRLEVELGRID_H
 
 #include "kgrglobals.h"
+#include "kgrnavfield.h"
+#include "kgrzobrist.h"
 
 #include <QList>
 #include <QObject>
@@ -32,7 +34,13 @@ public:
     }
 
     inline void gotGold (const int i, const int j, const bool runnerHasGold) {
-        layout [i + j * width] = (runnerHasGold) ? FREE : NUGGET;
+        const int  position = i + j * width;
+        const char type     = (runnerHasGold) ? FREE : NUGGET;
+        hash ^= KGrZobrist::key (KGrZobrist::Cell, position, layout [position])
+              ^ KGrZobrist::key (KGrZobrist::Cell, position, type);
+        layout [position] = type;
+        markChanged (position);
+        nav.cellChanged (i, j);
     }
 
     inline int enemyOccupied (int i, int j) {
@@ -49,6 +57,64 @@ public:
 
     void placeHiddenLadders();
 
+    /**
+     * Return the cells whose type or access flags have changed since the last
+     * call (or since calculateAccess()), as offsets in the grid (i + j * w),
+     * and start a new list.  Each cell is listed once, however many times it
+     * has changed.  Pathfinding can re-examine just these cells and a view can
+     * repaint just these cells.
+     */
+    QList<int> takeChanges();
+
+    /**
+     * Return a number that goes up whenever the type or access flags of any
+     * cell change, so that tables derived from the grid can tell when they
+     * are out of date (e.g. the distance fields of KGrScavengerRules).
+     */
+    inline int changeCount() const { return changeCounter; }
+
+    /**
+     * Return a hash of the types of all the cells, which is kept up to date
+     * at each change of type (see KGrZobrist), for KGrLevelPlayer::stateHash().
+     */
+    inline quint64 stateHash() const { return hash; }
+
+    /// A copy of the contents of the grid, as kept in a KGrLevelPlayer
+    /// snapshot.  The lists are implicitly shared, so copying is cheap.
+    typedef struct {
+        QList<char>  layout;
+        QList<Flags> heroAccess;
+        QList<Flags> enemyAccess;
+        QList<int>   enemyHere;
+        QList<int>   hiddenLadders;
+        KGrNavField  nav;
+        quint64      hash;
+    } State;
+
+    /**
+     * Copy the contents of the grid: the cells, their access flags, the enemy
+     * in each cell, the ladders still hidden, the navigation tables and the
+     * hash of the cells.
+     */
+    void saveState (State & s) const;
+
+    /**
+     * Put back contents copied by saveState() from this grid.  Each cell that
+     * differs from before is added to the list of changes (see takeChanges()).
+     */
+    void restoreState (const State & s);
+
+    inline int gridWidth() const { return width; }
+
+    /// Tables to help the Traditional rules find the way for an enemy to go.
+    inline const KGrNavField & navField() const { return nav; }
+
+    /// The width of the level-layout, not counting the surrounding wall.
+    inline int levelWidth() const  { return width - 2 * ConcreteWall; }
+
+    /// The height of the level-layout, not counting the surrounding wall.
+    inline int levelHeight() const { return height - 2 * ConcreteWall; }
+
 Q_SIGNALS:
     void showHiddenLadders (const QList<int> & ladders, const int width);
 
@@ -59,6 +125,14 @@ private:
 
     void calculateCellAccess (const int i, const int j);
 
+    inline void markChanged (const int position) {
+        changeCounter++;
+        if (! changed [position]) {
+            changed [position] = true;
+            changes.append (position);
+        }
+    }
+
     int  width;
     int  height;
 
@@ -69,6 +143,13 @@ private:
     QList<Flags> enemyAccess;
     QList<int>   enemyHere;
 
+    QList<bool>  changed;	// True if a cell is on the list of changes.
+    QList<int>   changes;	// Cells changed since the last takeChanges().
+    int          changeCounter;	// See changeCount().
+    quint64      hash;		// See stateHash().
+
+    KGrNavField  nav;		// Kept up to date with changes of layout.
+
     QList<int>   hiddenLadders;
     QList<int>   hiddenEnemies;
     QList<int>   flashingGold;
@@ -0,0 +1,148 @@
+/*
+    SPDX-FileCopyrightText: 2026 The KGoldrunner Developers
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#ifndef KGRLEVELOBSERVER_H
+#define KGRLEVELOBSERVER_H
+
+#include "kgrglobals.h"
+
+#include <QList>
+
+/**
+ * @short Interface between the game-engine and whatever displays the level
+ *
+ * KGrLevelPlayer, KGrHero and KGrEnemy report everything that has to be shown
+ * or animated through an object of this class, by plain virtual calls and not
+ * by Qt signals.  In KGoldrunner the observer is the KGrScene object.  A batch
+ * tool that only needs to run the rules (e.g. to check recordings) can use an
+ * instance of this class itself: every method has an empty default, so the
+ * level can be stepped with no QGraphicsScene, no window and no event loop.
+ *
+ * Sprite IDs are chosen by the game-engine.  The hero is always sprite 0 and
+ * the enemies are sprites 1 to n.  Dug bricks use higher IDs, which are re-used
+ * after the bricks close.
+ */
+class KGrLevelObserver
+{
+public:
+    virtual ~KGrLevelObserver() {}
+
+    /**
+     * Tells the view whether enemies show that they are carrying gold.
+     *
+     * @param showIt       True if the rules of this level show enemies' gold.
+     */
+    virtual void setGoldEnemiesRule (bool /* showIt */) {}
+
+    /**
+     * Tells the view the size of the level-layout, before any cells are
+     * painted.  Cells run from (1, 1) to (width, height).
+     *
+     * @param width        The number of columns in the level.
+     * @param height       The number of rows in the level.
+     */
+    virtual void setGridSize    (const int /* width */, const int /* height */) {}
+
+    /**
+     * Requests the view to display a particular type of tile at a particular
+     * cell, or make it empty and show the background (tileType = FREE).
+     *
+     * @param i            The column-number of the cell to paint.
+     * @param j            The row-number of the cell to paint.
+     * @param type         The type of tile to paint (gold, brick, ladder, etc).
+     */
+    virtual void paintCell      (const int /* i */, const int /* j */,
+                                 const char /* type */) {}
+
+    /**
+     * Requests the view to create a sprite for the hero, an enemy or a dug
+     * brick at a particular cell.
+     *
+     * @param spriteId     The ID of the new sprite.
+     * @param type         The type of sprite (HERO, ENEMY or BRICK).
+     * @param i            The column-number of the cell.
+     * @param j            The row-number of the cell.
+     */
+    virtual void makeSprite     (const int /* spriteId */, const char /* type */,
+                                 int /* i */, int /* j */) {}
+
+    /**
+     * Requests the view to display an animation of a runner or dug brick at a
+     * particular cell, cancelling and superseding any current animation.
+     *
+     * @param spriteId     The ID of the sprite (hero, enemy or dug brick).
+     * @param repeating    If true, repeat the animation (false for dug brick).
+     * @param i            The column-number of the cell.
+     * @param j            The row-number of the cell.
+     * @param time         The time in which to traverse one cell.
+     * @param dirn         The direction of motion (always STAND for dug brick).
+     * @param type         The type of animation (run, climb, open/close brick).
+     */
+    virtual void startAnimation (const int /* spriteId */,
+                                 const bool /* repeating */,
+                                 const int /* i */, const int /* j */,
+                                 const int /* time */,
+                                 const Direction /* dirn */,
+                                 const AnimationType /* type */) {}
+
+    /**
+     * Requests the view to delete a sprite (i.e. a dug brick that has closed).
+     *
+     * @param spriteId     The ID of the sprite.
+     */
+    virtual void deleteSprite   (const int /* spriteId */) {}
+
+    /**
+     * Requests the view to erase collected gold or show dropped gold.
+     *
+     * @param spriteId     The ID of the hero or enemy who has the gold.
+     * @param i            The column-number of the cell.
+     * @param j            The row-number of the cell.
+     * @param hasGold      True if gold was picked up: false if it was dropped.
+     * @param lost         True if the gold is lost.
+     */
+    virtual void gotGold        (const int /* spriteId */,
+                                 const int /* i */, const int /* j */,
+                                 const bool /* hasGold */,
+                                 const bool /* lost */) {}
+
+    /**
+     * Requests the view to show hidden ladders, when all the gold is gone.
+     *
+     * @param ladders      The grid-offsets of the hidden ladders.
+     * @param width        The width of the grid, used to decode the offsets.
+     */
+    virtual void showHiddenLadders (const QList<int> & /* ladders */,
+                                    const int /* width */) {}
+
+    /**
+     * Requests the view to update animated sprites, once per tick.
+     *
+     * @param missed       If true, moves and frame changes occur normally, but
+     *                     they are not displayed on the screen.
+     */
+    virtual void animate        (bool /* missed */) {}
+
+    /**
+     * Asks the view where the pointer is, in grid co-ordinates.  Returns -2 if
+     * the window is inactive.  The default has no pointer and returns (0, 0),
+     * which is enough for playing back a recording.
+     *
+     * @param i            The column-number of the pointer (return by ref).
+     * @param j            The row-number of the pointer (return by ref).
+     */
+    virtual void getMousePos    (int & i, int & j) { i = 0; j = 0; }
+
+    /**
+     * Requests the view to move the pointer to a particular cell.
+     *
+     * @param i            The column-number of the cell.
+     * @param j            The row-number of the cell.
+     */
+    virtual void setMousePos    (const int /* i */, const int /* j */) {}
+};
+
+#endif // KGRLEVELOBSERVER_H
@@ -4,32 +4,129 @@
     SPDX-License-Identifier: GPL-2.0-or-later
 */
 
+#include <algorithm>
+#include <climits>
 #include <cstdio>
 #include <cstdlib>
 
 #include <QRandomGenerator>
 
-// Include kgrgame.h only to access flags KGrGame::bugFix and KGrGame::logging.
-#include "kgrgame.h"
-#include "kgrscene.h"
-
 #include "kgrtimer.h"
-#include "kgrview.h"
 #include "kgrlevelplayer.h"
+#include "kgrlevelobserver.h"
 #include "kgrrulebook.h"
 #include "kgrlevelgrid.h"
 #include "kgrrunner.h"
+#include "kgrzobrist.h"
 #include "kgrdebug.h"
 
 #include "kgoldrunner_debug.h"
-#include <KMessageBox>	// TODO - Remove.
 
-KGrLevelPlayer::KGrLevelPlayer (KGrGame * parent, QRandomGenerator * pRandomGen)
+// The number of ticks in one cycle of the timing wheel that schedules enemies.
+// An enemy that is due to act after more ticks than this stays in its slot of
+// the wheel for one or more extra cycles.
+static const int WheelSize = 64;
+
+// The data of a snapshot (see KGrLevelPlayer::saveState()).  The runners are
+// in order of sprite ID: hero first, then the enemies.
+class KGrLevelPlayer::Snapshot::Data
+{
+public:
+    const KGrLevelPlayer *   player;	// The level player that took it.
+    KGrLevelGrid::State      grid;
+    KGrRunnerStore           runners;
+    QList<KGrRunner::State>  runnerStates;
+
+    QList<QList<int> >       enemiesInCell;
+    QList<int>               enemyCell;
+    QList<QList<int> >       wheel;
+    QList<int>               enemyDue;
+    QList<int>               enemyLastTick;
+    int                      wheelTick;
+    int                      wheelTime;
+
+    int                      spriteCount;
+    QList<int>               freeSpriteIds;
+    int                      nuggets;
+    PlayState                playState;
+
+    bool                     playback;
+    int                      recIndex;
+    int                      recCount;
+    int                      randIndex;
+    KGrRandom                random;
+
+    int                      targetI;
+    int                      targetJ;
+    Direction                direction;
+    Direction                newDirection;
+    int                      stepTime;
+    int                      dX;
+    int                      dY;
+
+    QList<DugBrick>          dugBricks;
+    int                      reappearIndex;
+    QList<int>               reappearPos;
+    int                      T;
+};
+
+// Put a byte into a recording stream, overwriting it or adding it at the end.
+// The streams start empty and grow as play goes on, with amortised O(1) cost
+// per byte (QByteArray grows its capacity geometrically), so memory use is in
+// proportion to the length of play and a recording has no limit on its length.
+static inline void putByte (QByteArray & stream, const int index,
+                            const uchar value)
+{
+    if (index < stream.size()) {
+        stream [index] = (char) value;
+    }
+    else {
+        stream.append (index + 1 - stream.size(), (char) value);
+    }
+}
+
+// End the recorded moves with END_CODE at the given index, dropping any moves
+// after it (e.g. when play goes on from a snapshot or an interrupted replay).
+static inline void putEndCode (QByteArray & content, const int index)
+{
+    content.truncate (index);
+    putByte (content, index, (uchar) END_CODE);
+}
+
+// Encode a pointer position for a recording.  Positions up to 127 use two
+// bytes (I and J).  Larger ones use TARGET_CODE and four bytes: the high parts
+// of I and J (plus 1) and the low 5 bits of I and J (plus 0xc0).  No byte can
+// be zero or END_CODE and the last two bytes cannot be mistaken for a small
+// pointer position or a direction code, when checking for repetitions.
+static int encodeTarget (const int i, const int j, uchar * out)
+{
+    if ((i < DIRECTION_CODE) && (j < DIRECTION_CODE)) {
+        out [0] = (uchar) i;
+        out [1] = (uchar) j;
+        return 2;
+    }
+    out [0] = (uchar) TARGET_CODE;
+    out [1] = (uchar) ((i >> 5) + 1);
+    out [2] = (uchar) ((j >> 5) + 1);
+    out [3] = (uchar) (0xc0 + (i & 0x1f));
+    out [4] = (uchar) (0xc0 + (j & 0x1f));
+    return 5;
+}
+
+// Decode a pointer position that starts with TARGET_CODE.
+static void decodeTarget (const uchar * in, int & i, int & j)
+{
+    i = ((in [1] - 1) << 5) + (in [3] - 0xc0);
+    j = ((in [2] - 1) << 5) + (in [4] - 0xc0);
+}
+
+KGrLevelPlayer::KGrLevelPlayer (QObject * parent, QRandomGenerator * pRandomGen)
     :
     QObject          (parent),
-    game             (parent),
+    observer         (nullptr),
     randomGen        (pRandomGen),
     hero             (nullptr),
+    spriteCount      (0),
     controlMode      (MOUSE),
     holdKeyOption    (CLICK_KEY),
     nuggets          (0),
@@ -41,42 +138,43 @@ KGrLevelPlayer::KGrLevelPlayer (KGrGame * parent, QRandomGenerator * pRandomGen)
     direction        (NO_DIRECTION),
     newDirection     (NO_DIRECTION),
     timer            (nullptr),
+    stepTime         (TickTime),
     digCycleTime     (200),	// Milliseconds per dig-timing cycle (default).
     digCycleCount    (40),	// Cycles while hole is fully open (default).
     digOpeningCycles (5),	// Cycles for brick-opening animation.
     digClosingCycles (4),	// Cycles for brick-closing animation.
     digKillingTime   (2),	// Cycle at which enemy/hero gets killed.
     dX               (0),	// X motion for KEYBOARD + HOLD_KEY option.
-    dY               (0)	// Y motion for KEYBOARD + HOLD_KEY option.
+    dY               (0),	// Y motion for KEYBOARD + HOLD_KEY option.
+    dugHash          (0),	// No bricks dug yet.
+    seekLimit        (-1),	// Not known until the level has been run.
+    divergence       (-1)	// No difference from the recording yet.
 {
     t.start(); // IDW
 
     dbgLevel = 0;
 }
 
-int KGrLevelPlayer::playerCount = 0;
+// Flags to control authors' debugging aids.
+bool KGrLevelPlayer::bugFix  = false;	// Start game with dynamic bug-fix OFF.
+bool KGrLevelPlayer::logging = false;	// Start game with dynamic logging OFF.
 
 KGrLevelPlayer::~KGrLevelPlayer()
 {
     qDeleteAll(dugBricks);
     dugBricks.clear(); //TODO: necessary?
     //qCDebug(KGOLDRUNNER_LOG) << "LEVEL PLAYER BEING DELETED.";
-    playerCount--;
 }
 
-void KGrLevelPlayer::init (KGrView * view,
+void KGrLevelPlayer::init (KGrLevelObserver * pObserver,
                            KGrRecording * pRecording,
                            const bool pPlayback,
-                           const bool gameFrozen)
+                           const bool gameFrozen,
+                           const bool timed)
 {
-    // TODO - Remove?
-    playerCount++;
-    if (playerCount > 1) {
-        KMessageBox::information (view,
-                QStringLiteral("ERROR: KGrLevelPlayer Count = %1").arg(playerCount),
-                QStringLiteral("KGrLevelPlayer"));
-    }
-
+    // Drawing requests go to the view through a buffer, once per tick.
+    renderBuffer.setView (pObserver);
+    observer  = &renderBuffer;
     recording = pRecording;
     playback  = pPlayback;
 
@@ -95,6 +193,10 @@ void KGrLevelPlayer::init (KGrView * view,
     reappearIndex   = levelWidth;	// Initialise the enemy-rebirth code.
     reappearPos.fill (1, levelWidth);
 
+    // No enemies are in any cells yet.
+    enemiesInCell.fill (QList<int>(),
+                        grid->gridWidth() * (levelHeight + 2 * ConcreteWall));
+
     // Set the rules of this game.
     switch (recording->rules) {
     case TraditionalRules:
@@ -111,22 +213,16 @@ void KGrLevelPlayer::init (KGrView * view,
     recIndex  = 0;
     recCount  = 0;
     randIndex = 0;
+    random.seed (recording->seed);
     T         = 0;
 
-    view->gameScene()->setGoldEnemiesRule (rules->enemiesShowGold());
+    observer->setGoldEnemiesRule (rules->enemiesShowGold());
+    observer->setGridSize (levelWidth, levelHeight);
 
     // Determine the access for hero and enemies to and from each grid-cell.
     grid->calculateAccess    (rules->runThruHole());
 
-    // Connect to code that paints grid cells and start-positions of sprites.
-    connect (this, &KGrLevelPlayer::paintCell, view->gameScene(), &KGrScene::paintCell);
-    connect (this, &KGrLevelPlayer::makeSprite, view->gameScene(), &KGrScene::makeSprite);
-
-    // Connect to the mouse-positioning code in the graphics.
-    connect (this, &KGrLevelPlayer::getMousePos, view->gameScene(), &KGrScene::getMousePos);
-    connect (this, &KGrLevelPlayer::setMousePos, view->gameScene(), &KGrScene::setMousePos);
-
-    // Show the layout of this level in the view (KGrCanvas).
+    // Show the layout of this level in the view (KGrScene).
     int wall = ConcreteWall;
     int enemyCount = 0;
     for (int j = wall ; j < levelHeight + wall; j++) {
@@ -145,18 +241,18 @@ void KGrLevelPlayer::init (KGrView * view,
 
             // If the hero is here, leave the tile empty.
             if (type == HERO) {
-                Q_EMIT paintCell (i, j, FREE);
+                observer->paintCell (i, j, FREE);
             }
 
             // If an enemy is here, count him and leave the tile empty.
             else if (type == ENEMY) {
                 enemyCount++;
-                Q_EMIT paintCell (i, j, FREE);
+                observer->paintCell (i, j, FREE);
             }
 
             // Or, just paint this tile.
             else {
-                Q_EMIT paintCell (i, j, type);
+                observer->paintCell (i, j, type);
             }
         }
     }
@@ -173,12 +269,12 @@ void KGrLevelPlayer::init (KGrView * view,
                 if (hero == nullptr) {
                     targetI = i;
                     targetJ = j;
-                    heroId  = Q_EMIT makeSprite (HERO, i, j);
+                    heroId  = makeSprite (HERO, i, j);
                     hero    = new KGrHero (this, grid, i, j, heroId, rules);
                     hero->setNuggets (nuggets);
                     hero->setDigWhileFalling (recording->digWhileFalling);
                     if ((controlMode == MOUSE) || (controlMode == LAPTOP)) {
-                        Q_EMIT setMousePos (targetI, targetJ);
+                        observer->setMousePos (targetI, targetJ);
                     }
                     grid->changeCellAt (i, j, FREE);	// Hero now a sprite.
                 }
@@ -192,60 +288,55 @@ void KGrLevelPlayer::init (KGrView * view,
             char type = grid->cellType (i, j);
             if (type == ENEMY) {
                 KGrEnemy * enemy;
-                int id = Q_EMIT makeSprite (ENEMY, i, j);
+                int id = makeSprite (ENEMY, i, j);
                 enemy = new KGrEnemy (this, grid, i, j, id, rules);
                 enemies.append (enemy);
                 grid->changeCellAt (i, j, FREE);	// Enemy now a sprite.
                 grid->setEnemyOccupied (i, j, id);
+                enemyEntersCell (id, i, j);
             }
         }
     }
 
-    // Connect the hero's and enemies' efforts to the graphics.
-    connect (this, &KGrLevelPlayer::gotGold, view->gameScene(), &KGrScene::gotGold);
-
-    // Connect mouse-clicks from KGrView to digging slot.
-    connect (view, &KGrView::mouseClick, this, &KGrLevelPlayer::doDig);
+    // Schedule the enemies at the first tick (see runEnemies()).
+    wheel.fill (QList<int>(), WheelSize);
+    enemyDue.fill (0, enemies.count());
+    enemyLastTick.fill (0, enemies.count());
+    wheelTick = 0;
+    wheelTime = 0;
 
-    // Connect the hero and enemies (if any) to the animation code.
-    connect (hero, &KGrHero::startAnimation, view->gameScene(), &KGrScene::startAnimation);
-
-    for (KGrEnemy * enemy : std::as_const(enemies)) {
-        connect (enemy, &KGrEnemy::startAnimation, view->gameScene(), &KGrScene::startAnimation);
-    }
-
-    // Connect the scoring.
-    connect (hero, &KGrHero::incScore, game, &KGrGame::incScore);
+    // Relay the scoring to the game (KGrGame).
+    connect (hero, &KGrHero::incScore, this, &KGrLevelPlayer::incScore);
     for (KGrEnemy * enemy : std::as_const(enemies)) {
-        connect (enemy, &KGrEnemy::incScore, game, &KGrGame::incScore);
+        connect (enemy, &KGrEnemy::incScore, this, &KGrLevelPlayer::incScore);
     }
 
-    // Connect the sounds.
-    connect (hero, &KGrHero::soundSignal, game, &KGrGame::playSound);
-
-    // Connect the level player to the animation code (for use with dug bricks).
-    connect (this, &KGrLevelPlayer::startAnimation, view->gameScene(), &KGrScene::startAnimation);
-
-    connect (this, &KGrLevelPlayer::deleteSprite, view->gameScene(), &KGrScene::deleteSprite);
+    // Relay the sounds to the game.
+    connect (hero, &KGrHero::soundSignal, this, &KGrLevelPlayer::playSound);
 
     // Connect the grid to the view, to show hidden ladders when the time comes.
-    connect (grid, &KGrLevelGrid::showHiddenLadders, view->gameScene(), &KGrScene::showHiddenLadders);
+    connect (grid, &KGrLevelGrid::showHiddenLadders, this,
+             [this] (const QList<int> & ladders, const int width) {
+                 observer->showHiddenLadders (ladders, width); });
 
-    // Connect and start the timer.  The tick() slot emits signal animation(),
+    // Connect and start the timer.  The tick() slot calls observer->animate(),
     // so there is just one time-source for the model and the view.
 
-    timer = new KGrTimer (this, TickTime);	// TickTime def in kgrglobals.h.
-    if (gameFrozen) {
-        timer->pause();				// Pause is ON as level starts.
-    }
+    if (timed) {
+        timer = new KGrTimer (this, TickTime);	// TickTime def in kgrglobals.h.
+        if (gameFrozen) {
+            timer->pause();			// Pause is ON as level starts.
+        }
 
-    connect (timer, &KGrTimer::tick, this, &KGrLevelPlayer::tick);
-    connect (this, &KGrLevelPlayer::animation, view->gameScene(), &KGrScene::animate);
+        connect (timer, &KGrTimer::tick, this, &KGrLevelPlayer::tick);
+    }
 
     if (! playback) {
         // Allow some time to view the level before starting a replay.
         recordInitialWaitTime (1500);		// 1500 msec or 1.5 sec.
     }
+
+    renderBuffer.flush();			// Show the level.
 }
 
 void KGrLevelPlayer::startDigging (Direction diggingDirection)
@@ -259,8 +350,8 @@ void KGrLevelPlayer::startDigging (Direction diggingDirection)
         grid->changeCellAt (digI, digJ, HOLE);
 
         // Start the brick-opening animation (non-repeating).
-        int id = Q_EMIT makeSprite (BRICK, digI, digJ);
-        Q_EMIT startAnimation (id, false, digI, digJ,
+        int id = makeSprite (BRICK, digI, digJ);
+        observer->startAnimation (id, false, digI, digJ,
                         (digOpeningCycles * digCycleTime), STAND, OPEN_BRICK);
 
         DugBrick * thisBrick = new DugBrick;
@@ -269,6 +360,7 @@ void KGrLevelPlayer::startDigging (Direction diggingDirection)
                     t.elapsed()}; // IDW test
         (* thisBrick)        = brick;
         dugBricks.append (thisBrick);
+        dugHash ^= dugBrickKey (thisBrick);
     }
 }
 
@@ -282,9 +374,10 @@ void KGrLevelPlayer::processDugBricks (const int scaledTime)
         dugBrick->cycleTimeLeft -= scaledTime;
         if (dugBrick->cycleTimeLeft < scaledTime) {
             dugBrick->cycleTimeLeft += digCycleTime;
+            dugHash ^= dugBrickKey (dugBrick);
             if (--dugBrick->countdown == digClosingCycles) {
                 // Start the brick-closing animation (non-repeating).
-                Q_EMIT startAnimation (dugBrick->id, false,
+                observer->startAnimation (dugBrick->id, false,
                                      dugBrick->digI, dugBrick->digJ,
                                      (digClosingCycles * digCycleTime),
                                      STAND, CLOSE_BRICK);
@@ -295,24 +388,322 @@ void KGrLevelPlayer::processDugBricks (const int scaledTime)
             }
             if (dugBrick->countdown <= 0) {
                 // Dispose of the dug brick and remove it from the list.
-                Q_EMIT deleteSprite (dugBrick->id);
+                deleteSprite (dugBrick->id);
                 delete dugBrick;
                 iterator.remove();
             }
+            else {
+                dugHash ^= dugBrickKey (dugBrick);
+            }
         }
     }
 }
 
+int KGrLevelPlayer::makeSprite (const char type, const int i, const int j)
+{
+    // The hero is sprite 0 and the enemies are sprites 1 to n, in the order of
+    // creation.  Dug bricks re-use the IDs of bricks that have closed.
+    int id = freeSpriteIds.isEmpty() ? spriteCount++ : freeSpriteIds.takeLast();
+    observer->makeSprite (id, type, i, j);
+    return id;
+}
+
+void KGrLevelPlayer::deleteSprite (const int spriteId)
+{
+    observer->deleteSprite (spriteId);
+    freeSpriteIds.append (spriteId);
+}
+
 void KGrLevelPlayer::prepareToPlay()
 {
     if ((controlMode == MOUSE) || (controlMode == LAPTOP)) {
-        Q_EMIT setMousePos (targetI, targetJ);
+        observer->setMousePos (targetI, targetJ);
     }
     playState = Ready;
 }
 
+int KGrLevelPlayer::runFixedStep (const int maxTicks)
+{
+    int result = NORMAL;
+    QMetaObject::Connection c = connect (this, &KGrLevelPlayer::endLevel, this,
+                                [&result] (const int status) {
+                                    result = status; });
+    if (playState == NotReady) {
+        prepareToPlay();
+    }
+
+    // Nothing is displayed, so all ticks are treated as "missed" by the view.
+    bool replaying = playback;
+    int  n = 0;
+    while ((playback == replaying) && (result == NORMAL) && (n < maxTicks)) {
+        tick (true, stepTime);
+        n++;
+    }
+
+    disconnect (c);
+    return result;
+}
+
+KGrLevelPlayer::Snapshot KGrLevelPlayer::saveState() const
+{
+    Snapshot::Data * d = new Snapshot::Data;
+    d->player        = this;
+    grid->saveState (d->grid);
+    d->runners       = runners;
+
+    d->runnerStates.resize (enemies.count() + 1);
+    hero->saveState (d->runnerStates [heroId]);
+    for (int n = 0; n < enemies.count(); n++) {
+        enemies.at (n)->saveState (d->runnerStates [n + 1]);
+    }
+
+    d->enemiesInCell = enemiesInCell;
+    d->enemyCell     = enemyCell;
+    d->wheel         = wheel;
+    d->enemyDue      = enemyDue;
+    d->enemyLastTick = enemyLastTick;
+    d->wheelTick     = wheelTick;
+    d->wheelTime     = wheelTime;
+
+    d->spriteCount   = spriteCount;
+    d->freeSpriteIds = freeSpriteIds;
+    d->nuggets       = nuggets;
+    d->playState     = playState;
+
+    d->playback      = playback;
+    d->recIndex      = recIndex;
+    d->recCount      = recCount;
+    d->randIndex     = randIndex;
+    d->random        = random;
+
+    d->targetI       = targetI;
+    d->targetJ       = targetJ;
+    d->direction     = direction;
+    d->newDirection  = newDirection;
+    d->stepTime      = stepTime;
+    d->dX            = dX;
+    d->dY            = dY;
+
+    for (const DugBrick * dugBrick : std::as_const(dugBricks)) {
+        d->dugBricks.append (* dugBrick);
+    }
+    d->reappearIndex = reappearIndex;
+    d->reappearPos   = reappearPos;
+    d->T             = T;
+
+    Snapshot snapshot;
+    snapshot.data.reset (d);
+    return snapshot;
+}
+
+bool KGrLevelPlayer::restoreState (const Snapshot & snapshot)
+{
+    if ((! snapshot.isValid()) || (snapshot.data->player != this)) {
+        return false;
+    }
+    const Snapshot::Data * d = snapshot.data.data();
+
+    // Remove the dug bricks from the view: the snapshot's ones come back later.
+    for (const DugBrick * dugBrick : std::as_const(dugBricks)) {
+        observer->deleteSprite (dugBrick->id);
+    }
+    qDeleteAll (dugBricks);
+    dugBricks.clear();
+    dugHash = 0;
+
+    grid->restoreState (d->grid);
+    runners       = d->runners;
+
+    enemiesInCell = d->enemiesInCell;
+    enemyCell     = d->enemyCell;
+    wheel         = d->wheel;
+    enemyDue      = d->enemyDue;
+    enemyLastTick = d->enemyLastTick;
+    wheelTick     = d->wheelTick;
+    wheelTime     = d->wheelTime;
+
+    spriteCount   = d->spriteCount;
+    freeSpriteIds = d->freeSpriteIds;
+    nuggets       = d->nuggets;
+    playState     = d->playState;
+
+    playback      = d->playback;
+    recIndex      = d->recIndex;
+    recCount      = d->recCount;
+    randIndex     = d->randIndex;
+    random        = d->random;
+
+    targetI       = d->targetI;
+    targetJ       = d->targetJ;
+    direction     = d->direction;
+    newDirection  = d->newDirection;
+    stepTime      = d->stepTime;
+    dX            = d->dX;
+    dY            = d->dY;
+
+    reappearIndex = d->reappearIndex;
+    reappearPos   = d->reappearPos;
+    T             = d->T;
+
+    for (const DugBrick & brick : d->dugBricks) {
+        DugBrick * dugBrick = new DugBrick;
+        (* dugBrick)        = brick;
+        dugBricks.append (dugBrick);
+        dugHash ^= dugBrickKey (dugBrick);
+    }
+
+    // Put back the hero and enemies, whose positions are now in the store.
+    hero->restoreState (d->runnerStates.at (heroId));
+    for (int n = 0; n < enemies.count(); n++) {
+        enemies.at (n)->restoreState (d->runnerStates.at (n + 1));
+    }
+
+    if (! playback) {
+        // Cut the recording back to where it was, so that play can go on from
+        // there.  The last repetition-count may have grown since then.
+        if (recCount > 0) {
+            putByte (recording->content, recIndex, (uchar) recCount);
+        }
+        putEndCode (recording->content, recIndex + 1);
+        recording->draws.truncate (randIndex);
+    }
+
+    redrawLevel();
+    renderBuffer.flush();			// Show the level as it was.
+    return true;
+}
+
+void KGrLevelPlayer::redrawLevel()
+{
+    // Repaint the grid, as in init().
+    int wall = ConcreteWall;
+    for (int j = wall ; j < levelHeight + wall; j++) {
+        for (int i = wall; i < levelWidth + wall; i++) {
+            char type = grid->cellType (i, j);
+
+            // Hide false bricks and show holes as bricks, under the sprites.
+            if ((type == FBRICK) || (type == HOLE) || (type == USEDHOLE)) {
+                type = BRICK;
+            }
+            observer->paintCell (i, j, type);
+        }
+    }
+
+    // Show the dug bricks.  A hole that is open is shown open at once and one
+    // that is closing closes in the time it has left.
+    for (const DugBrick * brick : std::as_const(dugBricks)) {
+        observer->makeSprite (brick->id, BRICK, brick->digI, brick->digJ);
+        if (brick->countdown > digClosingCycles) {
+            observer->startAnimation (brick->id, false,
+                                      brick->digI, brick->digJ,
+                                      TickTime, STAND, OPEN_BRICK);
+        }
+        else {
+            observer->startAnimation (brick->id, false,
+                                      brick->digI, brick->digJ,
+                                      (brick->countdown * digCycleTime),
+                                      STAND, CLOSE_BRICK);
+        }
+    }
+
+    hero->redraw (stepTime);
+    for (KGrEnemy * enemy : std::as_const(enemies)) {
+        enemy->redraw (stepTime);
+    }
+}
+
+int KGrLevelPlayer::seek (const int tick)
+{
+    if ((! playback) || (playState == NotReady)) {
+        return T;
+    }
+    int target = (tick < 0) ? 0 : tick;
+    if ((seekLimit >= 0) && (target > seekLimit)) {
+        target = seekLimit;
+    }
+
+    // Take the dug bricks out of the view, then run without the view and
+    // without signals to the game.
+    for (const DugBrick * dugBrick : std::as_const(dugBricks)) {
+        observer->deleteSprite (dugBrick->id);
+    }
+    renderBuffer.flush();
+    KGrLevelObserver * view = renderBuffer.getView();
+    renderBuffer.setView (nullptr);
+    bool wasBlocked = blockSignals (true);
+
+    bool ended = true;
+    while (ended) {
+        // Start from the latest keyframe at or before the target, unless the
+        // level is already nearer.
+        int k = qMin (target / KeyframeTicks, (int) keyframes.count() - 1);
+        if ((k >= 0) && ((T > target) || (k * KeyframeTicks > T))) {
+            restoreState (keyframes.at (k));
+        }
+
+        // Run the ticks as tick() would in playback, but stop at the end of
+        // the recording or just before the end of the level.
+        ended = false;
+        while (T < target) {
+            takeKeyframe();
+            if (! doRecordedMove()) {
+                seekLimit = T;
+                break;
+            }
+            if (playState != Playing) {
+                continue;
+            }
+            HeroStatus status = runTick (stepTime);
+            renderBuffer.flush();		// Discard the drawing requests.
+            if ((status == WON_LEVEL) || (status == DEAD)) {
+                seekLimit = T - 1;
+                target    = seekLimit;
+                ended     = true;		// Go back and stop one tick short.
+                break;
+            }
+        }
+    }
+
+    blockSignals (wasBlocked);
+    renderBuffer.setView (view);
+    redrawLevel();
+    renderBuffer.flush();
+    Q_EMIT tickPlayed (T);
+    return T;
+}
+
+int KGrLevelPlayer::replayLength()
+{
+    if ((! playback) || (playState == NotReady)) {
+        return -1;
+    }
+    if (seekLimit < 0) {
+        Snapshot now = saveState();
+        seek (INT_MAX);
+        restoreState (now);
+        Q_EMIT tickPlayed (T);
+    }
+    return seekLimit;
+}
+
+void KGrLevelPlayer::takeKeyframe()
+{
+    // Keyframes are taken in order, at the start of a tick, so that a seek can
+    // run on from one as tick() would.  Before prepareToPlay(), the recorded
+    // moves are ignored, so a seek could not run on.
+    if (playState == NotReady) {
+        return;
+    }
+    if ((T % KeyframeTicks == 0) && (T / KeyframeTicks == keyframes.count())) {
+        keyframes.append (saveState());
+    }
+}
+
 void KGrLevelPlayer::pause (bool stop)
 {
+    if (! timer) {
+        return;
+    }
     if (stop) {
         timer->pause();
     }
@@ -343,7 +734,12 @@ void KGrLevelPlayer::setTarget (int pointerI, int pointerJ)
     case Playing:
         // The human player is playing now.
         if (! playback) {
-            record (3, pointerI, pointerJ);
+            if ((pointerI < DIRECTION_CODE) && (pointerJ < DIRECTION_CODE)) {
+                record (3, pointerI, pointerJ);
+            }
+            else {
+                recordWideTarget (pointerI, pointerJ);
+            }
         }
         targetI = pointerI;
         targetJ = pointerJ;
@@ -381,6 +777,10 @@ void KGrLevelPlayer::doDig (int button)
     if (recordByte != 0) {
         // Record the digging action.
         record (1, recordByte);
+
+        // Show the hole now, not at the next tick, which could be a long
+        // time away if the game is paused.
+        renderBuffer.flush();
     }
 }
 
@@ -406,6 +806,7 @@ void KGrLevelPlayer::setDirectionByKey (const Direction dirn,
         }
         startDigging (dirn);
         record (1, (uchar) (DIRECTION_CODE + dirn));
+        renderBuffer.flush();		// Show the hole now, as in doDig().
     }
     else if (controlMode == KEYBOARD) {
         if (playState == Ready) {
@@ -479,17 +880,48 @@ void KGrLevelPlayer::recordInitialWaitTime (const int ms)
     // Allow a pause for viewing when playback starts.
     recCount = ms / TickTime;			// Convert milliseconds-->ticks.
     if (controlMode == KEYBOARD) {
-        recording->content [recIndex++]   = (uchar) (DIRECTION_CODE +
-                                                     NO_DIRECTION);
-        recording->content [recIndex]     = (uchar) recCount;
-        recording->content [recIndex + 1] = (uchar) END_CODE;
+        putByte (recording->content, recIndex++,
+                 (uchar) (DIRECTION_CODE + NO_DIRECTION));
+        putByte (recording->content, recIndex, (uchar) recCount);
+        putEndCode (recording->content, recIndex + 1);
     }
     else {
-        recording->content [recIndex++]   = (uchar) targetI;
-        recording->content [recIndex++]   = (uchar) targetJ;
-        recording->content [recIndex]     = (uchar) recCount;
-        recording->content [recIndex + 1] = (uchar) END_CODE;
+        uchar target [5];
+        int   n = encodeTarget (targetI, targetJ, target);
+        for (int k = 0; k < n; k++) {
+            putByte (recording->content, recIndex++, target [k]);
+        }
+        putByte (recording->content, recIndex, (uchar) recCount);
+        putEndCode (recording->content, recIndex + 1);
+    }
+}
+
+void KGrLevelPlayer::recordWideTarget (const int i, const int j)
+{
+    uchar target [5];
+    encodeTarget (i, j, target);
+
+    // Check for repetition of the previous pointer position, as in record().
+    bool repeat = (recCount > 0) && (recCount < (END_CODE - 1)) &&
+                  (recIndex > 5);
+    for (int k = 0; repeat && (k < 5); k++) {
+        repeat = ((uchar) recording->content [recIndex - 5 + k] == target [k]);
+    }
+    if (repeat) {
+        putByte (recording->content, recIndex, (uchar) (++recCount));
+        return;
+    }
+
+    for (int k = 0; k < 5; k++) {
+        putByte (recording->content, ++recIndex, target [k]);
     }
+    recCount = 1;
+    putByte (recording->content, ++recIndex, (uchar) recCount);
+    dbe2 "T %04d recIndex %03d REC: wide target %d %d - NEW TARGET\n",
+         T, recIndex - 5, i, j);
+
+    // Add the end-of-recording code (= 255).
+    putEndCode (recording->content, recIndex + 1);
 }
 
 void KGrLevelPlayer::record (const int bytes, const int n1, const int n2)
@@ -509,7 +941,7 @@ void KGrLevelPlayer::record (const int bytes, const int n1, const int n2)
                           (n2 == (uchar) recording->content [recIndex - 1]))
         )) {
         // Count repetitions, up to a maximum of (END_CODE - 1) = 254.
-        recording->content [recIndex]       = (uchar) (++recCount);
+        putByte (recording->content, recIndex, (uchar) (++recCount));
         if (bytes == 2) {
             dbe2 "T %04d recIndex %03d REC: codes --- %3d %3d - recCount++\n",
                  T, recIndex - 1, (uchar)(recording->content.at (recIndex-1)),
@@ -526,17 +958,17 @@ void KGrLevelPlayer::record (const int bytes, const int n1, const int n2)
 
     // Record a single code or the first byte of a new doublet or triplet.
     recCount = 0;
-    recording->content [++recIndex]         = (uchar) n1;
+    putByte (recording->content, ++recIndex, (uchar) n1);
 
     if (bytes == 3) {
         // Record another byte for a triplet (i.e. the pointer's J position).
-        recording->content [++recIndex] = (uchar) n2;
+        putByte (recording->content, ++recIndex, (uchar) n2);
     }
 
     if (bytes > 1) {
         // Record a repetition-count of 1 for a new doublet or triplet.
         recCount = 1;
-        recording->content [++recIndex]     = (uchar) recCount;
+        putByte (recording->content, ++recIndex, (uchar) recCount);
     }
 
     switch (bytes) {
@@ -561,7 +993,7 @@ void KGrLevelPlayer::record (const int bytes, const int n1, const int n2)
     }
 
     // Add the end-of-recording code (= 255).
-    recording->content [recIndex + 1] = (uchar) END_CODE;
+    putEndCode (recording->content, recIndex + 1);
     return;
 }
 
@@ -576,21 +1008,48 @@ Direction KGrLevelPlayer::getEnemyDirection (int  enemyI, int enemyJ,
                                grid, leftRightSearch);
 }
 
+void KGrLevelPlayer::nearbyCells (const int x, const int y,
+                                  int & iMin, int & iMax,
+                                  int & jMin, int & jMax)
+{
+    // An enemy is never more than one cell away from the cell it has reserved
+    // (it is moving into that cell) and heroCaught() and standOnEnemy() look
+    // for enemies less than a cell away from (x, y) or, for standOnEnemy(),
+    // less than a cell below.  So the enemies can only be in the cell that
+    // contains (x, y), or the one before it, or the two after it.
+    const int pointsPerCell = rules->pointsPerCell();
+    const int width         = grid->gridWidth();
+    const int height        = enemiesInCell.count() / width;
+    iMin = std::max (x / pointsPerCell - 1, 0);
+    iMax = std::min (x / pointsPerCell + 2, width - 1);
+    jMin = std::max (y / pointsPerCell - 1, 0);
+    jMax = std::min (y / pointsPerCell + 2, height - 1);
+}
+
 bool KGrLevelPlayer::heroCaught (const int heroX, const int heroY)
 {
     if (enemies.isEmpty()) {
         return false;
     }
-    int enemyX, enemyY, pointsPerCell_1;
-    for (KGrEnemy * enemy : std::as_const(enemies)) {
-        pointsPerCell_1 = enemy->whereAreYou (enemyX, enemyY) - 1;
-        if (((heroX < enemyX) ? ((heroX + pointsPerCell_1) >= enemyX) :
-                                 (heroX <= (enemyX + pointsPerCell_1))) &&
-            ((heroY < enemyY) ? ((heroY + pointsPerCell_1) > enemyY) :
-                                 (heroY <= (enemyY + pointsPerCell_1)))) {
-            // dbk << "Caught by";
-            // enemy->showState();
-            return true;
+    int enemyX, enemyY;
+    int pointsPerCell_1 = rules->pointsPerCell() - 1;
+    int iMin, iMax, jMin, jMax;
+    nearbyCells (heroX, heroY, iMin, iMax, jMin, jMax);
+    const int width = grid->gridWidth();
+    for (int j = jMin; j <= jMax; j++) {
+        for (int i = iMin; i <= iMax; i++) {
+            for (const int id : std::as_const(enemiesInCell [i + j * width])) {
+                enemyX = runners.gridX.at (id);
+                enemyY = runners.gridY.at (id);
+                if (((heroX < enemyX) ? ((heroX + pointsPerCell_1) >= enemyX) :
+                                         (heroX <= (enemyX + pointsPerCell_1))) &&
+                    ((heroY < enemyY) ? ((heroY + pointsPerCell_1) > enemyY) :
+                                         (heroY <= (enemyY + pointsPerCell_1)))) {
+                    // dbk << "Caught by";
+                    // enemy->showState();
+                    return true;
+                }
+            }
         }
     }
     return false;
@@ -603,17 +1062,33 @@ KGrEnemy * KGrLevelPlayer::standOnEnemy (const int spriteId,
     if (enemies.count() < minEnemies) {
         return nullptr;
     }
-    int enemyX, enemyY, pointsPerCell;
-    for (KGrEnemy * enemy : std::as_const(enemies)) {
-        pointsPerCell = enemy->whereAreYou (enemyX, enemyY);
-        if (((enemyY == (y + pointsPerCell)) ||
-             (enemyY == (y + pointsPerCell - 1))) &&
-            (enemyX > (x - pointsPerCell)) &&
-            (enemyX < (x + pointsPerCell))) {
-            return enemy;
+    int enemyX, enemyY;
+    int pointsPerCell = rules->pointsPerCell();
+    int iMin, iMax, jMin, jMax;
+    nearbyCells (x, y, iMin, iMax, jMin, jMax);
+    const int width = grid->gridWidth();
+
+    // If there are several enemies below, choose the first in the list of
+    // enemies, as when the whole list was searched.
+    int foundId = 0;
+    for (int j = jMin; j <= jMax; j++) {
+        for (int i = iMin; i <= iMax; i++) {
+            for (const int id : std::as_const(enemiesInCell [i + j * width])) {
+                if ((foundId > 0) && (id > foundId)) {
+                    continue;
+                }
+                enemyX = runners.gridX.at (id);
+                enemyY = runners.gridY.at (id);
+                if (((enemyY == (y + pointsPerCell)) ||
+                     (enemyY == (y + pointsPerCell - 1))) &&
+                    (enemyX > (x - pointsPerCell)) &&
+                    (enemyX < (x + pointsPerCell))) {
+                    foundId = id;
+                }
+            }
         }
     }
-    return nullptr;
+    return (foundId > 0) ? enemies.at (foundId - 1) : nullptr;
 }
 
 bool KGrLevelPlayer::bumpingFriend (const int spriteId, const Direction dirn,
@@ -644,12 +1119,12 @@ bool KGrLevelPlayer::bumpingFriend (const int spriteId, const Direction dirn,
         if (otherEnemy > 0) {
             dbk3 << otherEnemy << "at" << (gridI + dI) << gridJ
                      << "dirn" << ((otherEnemy > 0) ?
-                               (enemies.at (otherEnemy - 1)->direction()) : 0)
+                               (runners.direction.at (otherEnemy)) : 0)
                      << "me" << spriteId << "dirn" << dirn;
-            if (enemies.at (otherEnemy - 1)->direction() != dirn) {
+            if (runners.direction.at (otherEnemy) != dirn) {
                 dbk3 << spriteId << "wants" << dirn << ":" << otherEnemy
                          << "at" << (gridI + dI) << gridJ << "wants"
-                         << (enemies.at (otherEnemy - 1)->direction());
+                         << (runners.direction.at (otherEnemy));
                 return true;
             }
         }
@@ -659,12 +1134,12 @@ bool KGrLevelPlayer::bumpingFriend (const int spriteId, const Direction dirn,
         if (otherEnemy > 0) {
             dbk3 << otherEnemy << "at" << gridI << (gridJ + dJ)
                      << "dirn" << ((otherEnemy > 0) ?
-                               (enemies.at (otherEnemy - 1)->direction()) : 0)
+                               (runners.direction.at (otherEnemy)) : 0)
                      << "me" << spriteId << "dirn" << dirn;
-            if (enemies.at (otherEnemy - 1)->direction() != dirn) {
+            if (runners.direction.at (otherEnemy) != dirn) {
                 dbk3 << spriteId << "wants" << dirn << ":" << otherEnemy
                          << "at" << gridI << (gridJ + dJ) << "wants"
-                         << (enemies.at (otherEnemy - 1)->direction());
+                         << (runners.direction.at (otherEnemy));
                 return true;
             }
         }
@@ -692,23 +1167,65 @@ void KGrLevelPlayer::unstackEnemy (const int spriteId,
     }
 }
 
+void KGrLevelPlayer::enemyEntersCell (const int spriteId,
+                                      const int gridI, const int gridJ)
+{
+    enemyLeavesCell (spriteId);		// In case of a missing release.
+    while (enemyCell.count() < spriteId) {
+        enemyCell.append (-1);
+    }
+    int position = gridI + gridJ * grid->gridWidth();
+    enemyCell [spriteId - 1] = position;
+    enemiesInCell [position].append (spriteId);
+}
+
+void KGrLevelPlayer::enemyLeavesCell (const int spriteId)
+{
+    if ((spriteId > enemyCell.count()) || (enemyCell.at (spriteId - 1) < 0)) {
+        return;
+    }
+    enemiesInCell [enemyCell.at (spriteId - 1)].removeOne (spriteId);
+    enemyCell [spriteId - 1] = -1;
+}
+
 void KGrLevelPlayer::tick (bool missed, int scaledTime)
+{
+    int result = playTick (missed, scaledTime);
+    if ((result == WON_LEVEL) || (result == DEAD)) {
+        // Queued connection ensures KGrGame slot runs AFTER return from here.
+        Q_EMIT endLevel (result);
+        //qCDebug(KGOLDRUNNER_LOG) << "END OF LEVEL";
+    }
+}
+
+int KGrLevelPlayer::step (const Direction dirn)
+{
+    if (playState == NotReady) {
+        prepareToPlay();
+    }
+    setDirectionByKey (dirn, true);
+    return playTick (true, stepTime);
+}
+
+int KGrLevelPlayer::playTick (const bool missed, const int scaledTime)
 {
     int i, j;
-    Q_EMIT getMousePos (i, j);
+    observer->getMousePos (i, j);
     if (i == -2) {
-        return;         // The KGoldRunner window is inactive.
+        return NORMAL;		// The KGoldRunner window is inactive.
     }
     if ((i == -1) && (playback || (controlMode != KEYBOARD))) {
-        return;		// The pointer is outside the level layout.
+        return NORMAL;		// The pointer is outside the level layout.
     }
 
     if (playback) {			// Replay a recorded move.
+        takeKeyframe();
         if (! doRecordedMove()) {
             playback = false;
             // TODO - Should we emit interruptDemo() in UNEXPECTED_END case?
             dbk << "Unexpected END_OF_RECORDING - or KILL_HERO ACTION.";
-            return;			// End of recording.
+            renderBuffer.flush();
+            return NORMAL;		// End of recording.
         }
     }
     else if ((controlMode == MOUSE) || (controlMode == LAPTOP)) {
@@ -737,8 +1254,32 @@ void KGrLevelPlayer::tick (bool missed, int scaledTime)
     }
 
     if (playState != Playing) {
-        return;
+        renderBuffer.flush();
+        return NORMAL;
     }
+
+    HeroStatus status = runTick (scaledTime);
+    if ((status == WON_LEVEL) || (status == DEAD)) {
+        // Unsolicited timer-pause halts animation immediately, regardless of
+        // user-selected state. It's OK: KGrGame deletes KGrLevelPlayer v. soon.
+        if (timer) {
+            timer->pause();
+        }
+        renderBuffer.flush();
+        return status;
+    }
+
+    observer->animate (missed);		// Also passes on the drawing requests.
+    if (playback) {
+        Q_EMIT tickPlayed (T);
+    }
+    return NORMAL;
+}
+
+HeroStatus KGrLevelPlayer::runTick (const int scaledTime)
+{
+    // Move everything that moves in one tick: the dug bricks, the hero and,
+    // unless the level has ended, the enemies.
     T++;
 
     if (!dugBricks.isEmpty()) {
@@ -746,22 +1287,116 @@ void KGrLevelPlayer::tick (bool missed, int scaledTime)
     }
 
     HeroStatus status = hero->run (scaledTime);
-    if ((status == WON_LEVEL) || (status == DEAD)) {
-        // Unsolicited timer-pause halts animation immediately, regardless of
-        // user-selected state. It's OK: KGrGame deletes KGrLevelPlayer v. soon.
-        timer->pause();
+    if ((status != WON_LEVEL) && (status != DEAD)) {
+        runEnemies (scaledTime);
+    }
 
-        // Queued connection ensures KGrGame slot runs AFTER return from here.
-        Q_EMIT endLevel (status);
-        //qCDebug(KGOLDRUNNER_LOG) << "END OF LEVEL";
-        return;
+    checkState();
+    return status;
+}
+
+int KGrLevelPlayer::heroPosition (int & x, int & y)
+{
+    return hero->whereAreYou (x, y);
+}
+
+quint32 KGrLevelPlayer::stateChecksum() const
+{
+    quint64 h = stateHash();
+    return (quint32) (h ^ (h >> 32));
+}
+
+quint64 KGrLevelPlayer::stateHash() const
+{
+    // The hashes of the grid, the runners and the dug bricks are kept up to
+    // date as the level is played.  The time left is not included, because
+    // the enemies that are waiting are brought up to date only when they are
+    // due to act (see runEnemies()).
+    return grid->stateHash() ^ runners.hash ^ dugHash ^
+           KGrZobrist::key (KGrZobrist::Nuggets, nuggets);
+}
+
+quint64 KGrLevelPlayer::dugBrickKey (const DugBrick * dugBrick)
+{
+    return KGrZobrist::key (KGrZobrist::DugBrick, dugBrick->digI,
+                            dugBrick->digJ, dugBrick->countdown);
+}
+
+void KGrLevelPlayer::checkState()
+{
+    // Keep one byte of checksum per tick, which finds the exact tick where a
+    // replay first goes wrong, unless (1 time in 256) the bytes happen to match.
+    quint32 h   = stateChecksum();
+    char    sum = (char) (h ^ (h >> 8) ^ (h >> 16) ^ (h >> 24));
+    int     n   = T - 1;
+    if (! playback) {
+        // Cut back any checksums from a replay or a restored snapshot.
+        recording->checks.truncate (n);
+        recording->checks.append (sum);
     }
+    else if ((divergence < 0) && (n < recording->checks.size()) &&
+             (recording->checks.at (n) != sum)) {
+        divergence = T;
+        dbk << "Replay differs from recording after tick" << T;
+    }
+}
 
-    for (KGrEnemy * enemy : std::as_const(enemies)) {
+void KGrLevelPlayer::runEnemies (const int scaledTime)
+{
+    wheelTick++;
+    if (scaledTime != wheelTime) {
+        rescheduleEnemies (scaledTime);	// The game's speed has changed.
+    }
+
+    // Find the enemies that are due to act in this tick.  The others in this
+    // slot of the wheel are due in a later cycle.
+    QList<int> & slot = wheel [wheelTick % WheelSize];
+    QList<int>   due;
+    for (int n = slot.count() - 1; n >= 0; n--) {
+        if (enemyDue.at (slot.at (n)) == wheelTick) {
+            due.append (slot.takeAt (n));
+        }
+    }
+
+    // Run them in the same order as the list of enemies, as if every enemy
+    // had been run and those not due had just waited.  They must be run one
+    // at a time, because each move depends on the moves before it.
+    std::sort (due.begin(), due.end());
+    for (const int index : std::as_const(due)) {
+        KGrEnemy * enemy = enemies.at (index);
+        runners.skipTicks (index + 1, wheelTick - enemyLastTick.at (index) - 1,
+                           wheelTime);
         enemy->run (scaledTime);
+        scheduleEnemy (index, wheelTick);
     }
+}
 
-    Q_EMIT animation (missed);
+void KGrLevelPlayer::scheduleEnemy (const int index, const int fromTick)
+{
+    // The enemy's sprite ID is its index in the list of enemies plus 1.
+    int dueTick            = fromTick + 1 +
+                             runners.ticksToWait (index + 1, wheelTime);
+    enemyDue      [index]  = dueTick;
+    enemyLastTick [index]  = fromTick;
+    wheel [dueTick % WheelSize].append (index);
+}
+
+void KGrLevelPlayer::rescheduleEnemies (const int scaledTime)
+{
+    // Let the enemies wait out the ticks that have passed at the old speed,
+    // then schedule them all again at the new speed.
+    int lastTick = wheelTick - 1;
+    for (QList<int> & slot : wheel) {
+        slot.clear();
+    }
+    for (int index = 0; index < enemies.count(); index++) {
+        runners.skipTicks (index + 1, lastTick - enemyLastTick.at (index),
+                           wheelTime);
+    }
+    wheelTime = scaledTime;
+    for (int index = 0; index < enemies.count(); index++) {
+        scheduleEnemy (index, lastTick);
+    }
 }
 
 int KGrLevelPlayer::runnerGotGold (const int  spriteId,
@@ -780,7 +1415,7 @@ int KGrLevelPlayer::runnerGotGold (const int  spriteId,
     if (! lost) {
         grid->gotGold (i, j, hasGold);		// Record pickup/drop on grid.
     }
-    Q_EMIT gotGold (spriteId, i, j, hasGold, lost); // Erase/show gold on screen.
+    observer->gotGold (spriteId, i, j, hasGold, lost); // Erase/show gold.
 
     // If hero got gold, score, maybe show hidden ladders, maybe end the level.
     if ((spriteId == heroId) || lost) {
@@ -813,7 +1448,8 @@ void KGrLevelPlayer::makeReappearanceSequence()
     // Shuffle the co-ordinates of reappearance positions (1 to levelWidth).
     for (int k = 0; k < levelWidth; k++) {
         // Pick a random element from those that are left.
-        z = (int) (randomByte ((uchar) left));
+        z = (left <= 255) ? (int) (randomByte ((uchar) left)) :
+                            randomIndex (left);
         // Exchange its value with the last of the ones left.
         temp = reappearPos [z];
         reappearPos [z] = reappearPos [left - 1];
@@ -869,30 +1505,70 @@ void KGrLevelPlayer::enemyReappear (int & gridI, int & gridJ)
     gridJ = j;
 }
 
+int KGrLevelPlayer::randomIndex (const int limit)
+{
+    // Use two random bytes if the limit is too large for one (i.e. a level
+    // more than 255 cells wide).  This makes only a small bias.
+    int high = randomByte ((uchar) ((limit + 249) / 250));
+    int low  = randomByte (250);
+    return (high * 250 + low) % limit;
+}
+
 uchar KGrLevelPlayer::randomByte (const uchar limit)
 {
-    if (! playback) {
+    if (recording->seed != 0) {
+        // Recording or playback, the numbers come from the seed.
+        uchar value = random.bounded (limit);
+        dbe2 "Draw %03d, seeded, limit %02d\n", value, limit);
+        return value;
+    }
+    else if (! playback) {
         uchar value = randomGen->bounded(limit);
         // A zero-byte terminates recording->draws, so add 1 when recording ...
         dbe2 "Draw %03d, index %04d, limit %02d\n", value, randIndex, limit);
-        recording->draws [randIndex++] = value + 1;
+        putByte (recording->draws, randIndex++, value + 1);
         return value;
     }
     else {
-        dbe2 "Draw %03d, index %04d, limit %02d\n",
-             (recording->draws.at (randIndex) - 1), randIndex, limit);
+        // A recording that has run out of draws gives zero-bytes, as before.
+        uchar draw = (randIndex < recording->draws.size()) ?
+                     (uchar) recording->draws.at (randIndex) : 0;
+        dbe2 "Draw %03d, index %04d, limit %02d\n", draw - 1, randIndex, limit);
+        randIndex++;
         // and subtract 1 when replaying.
-        return ((uchar) recording->draws.at (randIndex++) - 1);
+        return (draw - 1);
+    }
+}
+
+// Return the number of bytes in a recorded move that starts with a given code.
+static int moveLength (const uchar code)
+{
+    if (code < DIRECTION_CODE) {
+        return 3;			// Pointer position and repeat-count.
     }
+    if (code < MODE_CODE) {
+        int dirn = code - DIRECTION_CODE;
+        return ((dirn == DIG_LEFT) || (dirn == DIG_RIGHT)) ? 1 : 2;
+    }
+    return (code == TARGET_CODE) ? 6 : 1;
 }
 
 bool KGrLevelPlayer::doRecordedMove()
 {
+    // The loaders end the content with only one zero-byte, so a recording
+    // that is damaged or cut short (e.g. a file given to kgoldrunner_verify)
+    // could end in the middle of a move.  It is read as if it ended before it.
+    const QByteArray & content = recording->content;
+    auto codeAt = [&content] (const int k) -> uchar {
+                      return (k < content.size()) ? content.at (k) : 0;
+                  };
+
     int i, j;
-    uchar code = recording->content [recIndex];
+    uchar code = codeAt (recIndex);
     while (true) {
         // Check for end of recording.
-        if ((code == END_CODE) || (code == 0)) {
+        if ((code == END_CODE) || (code == 0) ||
+            (recIndex + moveLength (code) > content.size())) {
             dbe2 "T %04d recIndex %03d PLAY - END of recording\n",
                  T, recIndex);
             Q_EMIT endLevel (UNEXPECTED_END);
@@ -937,7 +1613,7 @@ bool KGrLevelPlayer::doRecordedMove()
                      T, recIndex, code);
                 startDigging ((Direction) (code));
                 recIndex++;
-                code = recording->content [recIndex];
+                code = codeAt (recIndex);
                 recCount = 0;
                 continue;
             }
@@ -969,7 +1645,7 @@ bool KGrLevelPlayer::doRecordedMove()
                  T, recIndex, code);
             setControlMode (code - MODE_CODE);
             recIndex++;
-            code = recording->content [recIndex];
+            code = codeAt (recIndex);
             recCount = 0;
             continue;
         }
@@ -980,11 +1656,27 @@ bool KGrLevelPlayer::doRecordedMove()
                  T, recIndex, code);
             setHoldKeyOption (code - KEY_OPT_CODE + CLICK_KEY);
             recIndex++;
-            code = recording->content [recIndex];
+            code = codeAt (recIndex);
             recCount = 0;
             continue;
         }
 
+        // Simulate a recorded pointer position in a very large level.
+        else if (code == TARGET_CODE) {
+            if (recCount <= 0) {
+                decodeTarget ((const uchar *) recording->content.constData() +
+                              recIndex, i, j);
+                recCount = (uchar)(recording->content [recIndex + 5]);
+                dbe2 "T %04d recIndex %03d PLAY wide target %d %d %d\n",
+                     T, recIndex, i, j, recCount);
+                setTarget (i, j);
+            }
+            if (--recCount <= 0) {
+                recIndex = recIndex + 6;
+            }
+            break;
+        }
+
         // Replay an action, such as KILL_HERO.
         else if (code < SPEED_CODE) {
             if (code == (ACTION_CODE + KILL_HERO)) {
@@ -1001,7 +1693,7 @@ bool KGrLevelPlayer::doRecordedMove()
                  T, recIndex, code);
             setTimeScale (code - SPEED_CODE);
             recIndex++;
-            code = recording->content [recIndex];
+            code = codeAt (recIndex);
             recCount = 0;
             continue;
         }
@@ -1016,8 +1708,11 @@ void KGrLevelPlayer::interruptPlayback()
         return;
     }
 
-    uchar code = recording->content [recIndex];
     // Check for end-of-recording already reached.
+    if (recIndex >= recording->content.size()) {
+        return;
+    }
+    uchar code = recording->content [recIndex];
     if ((code == END_CODE) || (code == 0)) {
         return;
     }
@@ -1060,15 +1755,16 @@ void KGrLevelPlayer::interruptPlayback()
             recording->content [recIndex + 2] = (uchar) (recCount);
             recIndex = recIndex + 2;	// Count here if mouse in same position.
         }
+        else if (code == TARGET_CODE) {
+            // The same, for a pointer position in a very large level.
+            recCount = (uchar)(recording->content [recIndex + 5]) - recCount;
+            recording->content [recIndex + 5] = (uchar) (recCount);
+            recIndex = recIndex + 5;
+        }
     }
 
-    recording->content [recIndex + 1] = static_cast<char>(END_CODE);
-    for (int i = (recIndex + 2); i < recording->content.size(); i++) {
-        recording->content [i] = 0;
-    }
-    for (int i = randIndex; i < recording->draws.size(); i++) {
-        recording->draws [i] = 0;
-    }
+    putEndCode (recording->content, recIndex + 1);
+    recording->draws.truncate (randIndex);
 
 // Start debug stuff.
     dbk2 << "recIndex" << recIndex << "recCount" << recCount
@@ -1131,7 +1827,11 @@ void KGrLevelPlayer::setHoldKeyOption  (const int option)
 
 void KGrLevelPlayer::setTimeScale  (const int timeScale)
 {
-    timer->setScale ((float) (timeScale * 0.1));
+    float scale = (float) (timeScale * 0.1);
+    if (timer) {
+        timer->setScale (scale);
+    }
+    stepTime = KGrTimer::scaleTickTime (TickTime, scale);
 
     if (! playback) {
         record (1, SPEED_CODE + timeScale);
@@ -1146,10 +1846,12 @@ void KGrLevelPlayer::dbgControl (int code)
 {
     switch (code) {
     case DO_STEP:
-        timer->step();			// Do one timer step only.
+        if (timer) {
+            timer->step();		// Do one timer step only.
+        }
         break;
     case BUG_FIX:
-        bugFix();			// Turn a bug fix on/off dynamically.
+        toggleBugFix();			// Turn a bug fix on/off dynamically.
         break;
     case LOGGING:
         startLogging();			// Turn logging on/off.
@@ -1169,20 +1871,20 @@ void KGrLevelPlayer::dbgControl (int code)
     }
 }
 
-void KGrLevelPlayer::bugFix()
+void KGrLevelPlayer::toggleBugFix()
 {
     // Toggle a bug fix on/off dynamically.
-    KGrGame::bugFix = (KGrGame::bugFix) ? false : true;
-    fprintf (stderr, "%s", (KGrGame::bugFix) ? "\n" : "");
-    fprintf (stderr, ">> Bug fix is %s\n", (KGrGame::bugFix) ? "ON" : "OFF\n");
+    bugFix = (bugFix) ? false : true;
+    fprintf (stderr, "%s", (bugFix) ? "\n" : "");
+    fprintf (stderr, ">> Bug fix is %s\n", (bugFix) ? "ON" : "OFF\n");
 }
 
 void KGrLevelPlayer::startLogging()
 {
     // Toggle logging on/off dynamically.
-    KGrGame::logging = (KGrGame::logging) ? false : true;
-    fprintf (stderr, "%s", (KGrGame::logging) ? "\n" : "");
-    fprintf (stderr, ">> Logging is %s\n", (KGrGame::logging) ? "ON" : "OFF\n");
+    logging = (logging) ? false : true;
+    fprintf (stderr, "%s", (logging) ? "\n" : "");
+    fprintf (stderr, ">> Logging is %s\n", (logging) ? "ON" : "OFF\n");
 }
 
 void KGrLevelPlayer::showFigurePositions()
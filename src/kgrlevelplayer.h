@@ -8,19 +8,22 @@
 #define KGRLEVELPLAYER_H
 
 #include "kgrglobals.h"
+#include "kgrrandom.h"
+#include "kgrrenderbuffer.h"
+#include "kgrrunnerstore.h"
 
 #include <QList>
 #include <QObject>
+#include <QSharedPointer>
 #include <QVarLengthArray>
 
 #include <QElapsedTimer> // IDW testing
 
 class KGrTimer;
 class KGrLevelGrid;
+class KGrLevelObserver;
 class KGrRuleBook;
-class KGrView;
 class KGrHero;
-class KGrGame;
 class KGrEnemy;
 
 class QRandomGenerator;
@@ -48,8 +51,11 @@ class QRandomGenerator;
  * its own distinct algorithm.  In playback mode, the inputs are emulated.
  *
  * KGrLevelPlayer and friends are the internal model and game-engine of
- * KGoldrunner and they communicate with the view, KGrCanvas and friends,
- * solely via signals that indicate what is moving and what has to be painted.
+ * KGoldrunner.  They are built into a separate library, which needs no GUI
+ * libraries.  They tell the view (KGrScene) what is moving and what has to be
+ * painted through a KGrLevelObserver object and they tell the game (KGrGame)
+ * about scores, sounds and the end of the level via signals.  So a level can
+ * be played without any graphics at all, as when checking recordings.
  */
 
 class KGrLevelPlayer : public QObject
@@ -64,7 +70,7 @@ public:
      *                   play.
      * @param pRandomGen A shared source of random numbers for all enemies.
      */
-    KGrLevelPlayer             (KGrGame * parent, QRandomGenerator * pRandomGen);
+    KGrLevelPlayer             (QObject * parent, QRandomGenerator * pRandomGen);
     ~KGrLevelPlayer() override;
 
     /**
@@ -72,11 +78,14 @@ public:
      * playing rules to be used, creates the internal playing-grid, creates the
      * hero and enemies and connects the various signals and slots together.  It
      * also initialises the recording or playback of moves made by the hero and
-     * enemies.  Note that this is the only place where KGrLevelPlayer uses the
-     * view directly.  All other references are via signals and slots.
+     * enemies.  KGrLevelPlayer does not use the view directly.  All references
+     * to the view are via the observer and drawing requests are buffered in a
+     * KGrRenderBuffer, which passes them on to the observer once per tick.
      *
      *
-     * @param view       Points to the KGrCanvas object that provides graphics.
+     * @param pObserver  Points to the object that displays the level (usually
+     *                   KGrScene).  It must stay valid until the level player
+     *                   is deleted.
      * @param pRecording Points to a data-object that contains all the data for
      *                   the level, including the layout of the maze and the
      *                   starting positions of hero, enemies and gold, plus the
@@ -92,11 +101,173 @@ public:
      * @param pPlayback  If false, play "live" and record the play.  If true,
      *                   play back a previously recorded level.
      * @param gameFrozen If true, go into pause-mode when the level starts.
+     * @param timed      If true, create a KGrTimer to run the level in real
+     *                   time.  If false, there is no timer and the level can
+     *                   be replayed only by calling runFixedStep().
      */
-    void init                   (KGrView *            view,
+    void init                   (KGrLevelObserver *   pObserver,
                                  KGrRecording *       pRecording,
                                  const bool           pPlayback,
-                                 const bool           gameFrozen);
+                                 const bool           gameFrozen,
+                                 const bool           timed = true);
+
+    /**
+     * Replay a recorded level as fast as possible, by calling the tick() slot
+     * in a loop, with no timer and no delays in the event loop.  The scaled
+     * time of each tick is the same as KGrTimer would give at the recorded
+     * speed and the random draws come from the recording, so the results are
+     * exactly the same as in a timed replay, but are obtained in a fraction
+     * of the time.  Calls prepareToPlay() if that has not been done already.
+     *
+     * In live play, as when KGrSolver searches for a solution, the ticks use
+     * the inputs given so far (e.g. by setDirectionByKey()) and are recorded.
+     *
+     * @param maxTicks  The maximum number of ticks to run, as a safeguard
+     *                  against recordings that never end, or the number of
+     *                  ticks to run in live play.
+     *
+     * @return          The result: WON_LEVEL, DEAD or UNEXPECTED_END, or
+     *                  NORMAL if the level has not ended when playback stops
+     *                  or maxTicks runs out.
+     */
+    int  runFixedStep           (const int maxTicks = 1000000);
+
+    /**
+     * Play one tick "live", as if a key had been pressed just before it, with
+     * no timer and no signals (e.g. for KGrEnvironment, which steps many
+     * levels at once).  The control mode must be KEYBOARD, with the CLICK_KEY
+     * option.  Calls prepareToPlay() if that has not been done already.
+     *
+     * @param dirn      The key: a Direction from STAND to DIG_LEFT.
+     *
+     * @return          The result: WON_LEVEL, DEAD or NORMAL.
+     */
+    int  step                   (const Direction dirn);
+
+    /**
+     * Return the number of ticks that have been played since the hero started
+     * moving.
+     */
+    inline int tickCount        () const { return T; }
+
+    /**
+     * Find where the hero is, in grid-points.
+     *
+     * @param x         The X grid-position of the hero (return by reference).
+     * @param y         The Y grid-position of the hero (return by reference).
+     *
+     * @return          The number of grid-points in each cell.
+     */
+    int  heroPosition           (int & x, int & y);
+
+    /**
+     * Return the number of pieces of gold still to be collected by the hero.
+     */
+    inline int goldLeft         () const { return nuggets; }
+
+    /**
+     * Return the grid of the level, e.g. for KGrSolver to find how far the hero
+     * is from the gold.  It must not be changed.
+     */
+    inline KGrLevelGrid * levelGrid () const { return grid; }
+
+    /**
+     * A copy of the complete state of a level in play: the grid, the hero and
+     * enemies, the dug bricks, the enemy-rebirth sequence, the gold and the
+     * places reached in the recording.  A snapshot is a value: copying one is
+     * cheap, because the data is shared and is never changed once taken.  It
+     * can be restored only to the level player that took it.
+     */
+    class Snapshot
+    {
+    public:
+        /// Returns true if the snapshot holds a copy of a level.
+        inline bool isValid() const { return (! data.isNull()); }
+
+    private:
+        friend class KGrLevelPlayer;
+        class Data;				// Defined in kgrlevelplayer.cpp.
+        QSharedPointer<const Data> data;
+    };
+
+    /**
+     * Take a snapshot of the level as it is now, e.g. to restart it instantly,
+     * quick-save it or rewind it later, or to try out moves when searching.
+     * No objects are created other than the snapshot's data.
+     *
+     * @return          The snapshot.
+     */
+    Snapshot saveState          () const;
+
+    /**
+     * Put the level back as it was when a snapshot was taken, using the same
+     * hero, enemies and grid, and bring the view up to date.  When recording,
+     * the recording is cut back to the same point, so that play can continue
+     * from there.  The speed and control settings are not changed.
+     *
+     * @param snapshot  A snapshot taken by saveState() of this level player.
+     *
+     * @return          False if the snapshot is empty or is from another level.
+     */
+    bool restoreState           (const Snapshot & snapshot);
+
+    /**
+     * Go to a tick of a recorded level during playback, by restoring the
+     * nearest keyframe before it (see saveState()) and running the rest of the
+     * way without the view, then bring the view up to date.  Keyframes are
+     * taken every KeyframeTicks ticks as the level is played back, or as it
+     * is run through by seek() or replayLength().  A seek never goes as far
+     * as the end of the level: it stops one tick short, so that the level can
+     * end in the normal way.  No scores or sounds are signalled for the ticks
+     * that are skipped.
+     *
+     * @param tick      The required tick (see tickCount()).
+     *
+     * @return          The tick reached, or the current tick if the level is
+     *                  not in playback mode or prepareToPlay() has not been
+     *                  called.
+     */
+    int  seek                   (const int tick);
+
+    /**
+     * Return the number of ticks to which seek() can go in the recording being
+     * played back.  The first time, the recording is run through to the end,
+     * without the view, taking keyframes on the way, and then the level goes
+     * back to where it was.
+     *
+     * @return          The number of ticks, or -1 if not in playback mode or
+     *                  prepareToPlay() has not been called.
+     */
+    int  replayLength           ();
+
+    /// The number of ticks between keyframes.  Running this many ticks takes
+    /// much less time than is noticeable.
+    static const int KeyframeTicks = 100;
+
+    /**
+     * Return a checksum of the state of the level: the cells of the grid, the
+     * positions and directions of the hero and enemies, the dug bricks and
+     * the gold remaining.  While recording, a checksum is stored after each
+     * tick and in playback it is checked (see divergentTick()).
+     */
+    quint32 stateChecksum       () const;
+
+    /**
+     * Return a 64-bit hash of the same state as stateChecksum(), e.g. to find
+     * states that have been reached before when searching for a solution.
+     * The hash is kept up to date at each change of state (see KGrZobrist),
+     * so it takes the same short time however large the level is.
+     */
+    quint64 stateHash           () const;
+
+    /**
+     * Return the first tick after which the state of the level in playback
+     * differed from the checksum stored in the recording, or -1 if it has not
+     * differed (or the recording has no checksums).  The rules or the engine
+     * must have changed between recording and playback: the hero might go on
+     * to die or the recording might end much later.
+     */
+    inline int divergentTick    () const { return divergence; }
 
     /**
      * Indicate that setup is complete and the human player can start playing
@@ -258,6 +429,28 @@ public:
     void unstackEnemy           (const int spriteId,
                                  const int gridI, const int gridJ,
                                  const int prevEnemy);
+
+    /**
+     * Helper function to keep track of the cell that each enemy has reserved,
+     * so that heroCaught() and standOnEnemy() need look only at the enemies
+     * in nearby cells.  It is called whenever an enemy reserves a cell.
+     *
+     * @param spriteId  The identifier of the enemy.
+     * @param gridI     The column-position of the cell.
+     * @param gridJ     The row-position of the cell.
+     */
+    void enemyEntersCell        (const int spriteId,
+                                 const int gridI, const int gridJ);
+
+    /**
+     * Helper function to remove an enemy from the cell it has reserved, as kept
+     * track of by enemyEntersCell().  It is called whenever an enemy releases
+     * a cell.
+     *
+     * @param spriteId  The identifier of the enemy.
+     */
+    void enemyLeavesCell        (const int spriteId);
+
     /**
      * Helper function to determine where an enemy should reappear after being
      * trapped in a brick.  This applies with Traditional and Scavenger rules
@@ -270,10 +463,13 @@ public:
 
     /**
      * Helper function to provide enemies with random numbers for reappearing
-     * and deciding whether to pick up or drop gold.  The random bytes
-     * generated are stored during recording and re-used during playback, so
-     * that play is completely reproducible, even if the library's random number
-     * generator behavior should vary across platforms or in future versions.
+     * and deciding whether to pick up or drop gold.  If the recording has a
+     * seed, the numbers come from KGrRandom, whose sequence is fixed, and are
+     * generated again during playback.  In older recordings, the random bytes
+     * generated are stored during recording and re-used during playback.
+     * Either way, play is completely reproducible, even if the library's
+     * random number generator behavior should vary across platforms or in
+     * future versions.
      *
      * @param limit     The upper limit for the number to be returned.
      *
@@ -281,6 +477,17 @@ public:
      */
     uchar randomByte            (const uchar limit);
 
+    /**
+     * Returns the object that displays the level, for use by the runners.
+     */
+    inline KGrLevelObserver * levelObserver() { return observer; }
+
+    /**
+     * Returns the store of the positions, times and directions of the hero and
+     * enemies, for use by the runners.
+     */
+    inline KGrRunnerStore * runnerStore() { return &runners; }
+
     /**
      * Implement author's debugging aids, which are activated only if the level
      * is paused and the KConfig file contains group Debugging with setting
@@ -293,72 +500,58 @@ public:
      *
      * To use the BUG_FIX or LOGGING options, first patch in and compile some
      * code to achieve the effect required, with tests of static bool flags
-     * KGrGame::bugFix or KGrGame::logging surrounding that code.  The relevant
-     * keystrokes then toggle those flags, so as to execute or skip the code
-     * dynamically as the game runs.
+     * KGrLevelPlayer::bugFix or KGrLevelPlayer::logging surrounding that code.
+     * The relevant keystrokes then toggle those flags, so as to execute or skip
+     * the code dynamically as the game runs.
      *
      * @param code      A code to indicate the action required (see enum
      *                  DebugCodes in file kgrglobals.h).
      */
     void dbgControl             (int code);	// Authors' debugging aids.
 
+    // Flags to control authors' debugging aids.
+    static bool bugFix;
+    static bool logging;
+
 Q_SIGNALS:
     void endLevel       (const int result);
-    void getMousePos    (int & i, int & j);
-    void setMousePos    (const int i, const int j);
+    void interruptDemo  ();
 
     /**
-     * Requests the view to update animated sprites. Each sprite moves as
-     * decided by the parameters of its last startAnimation() signal.
+     * Requests the KGoldrunner game to add to the human player's score.  The
+     * signal is relayed from the hero and enemies.
      *
-     * @param missed       If true, moves and frame changes occur normally, but
-     *                     they are not displayed on the screen. This is to
-     *                     allow the graphics to catch up if Qt has missed one
-     *                     or more time signals.
+     * @param n            The amount to add to the score.
      */
-    void animation      (bool missed);
+    void incScore       (const int n);
 
     /**
-     * Requests the view to display a particular type of tile at a particular
-     * cell, or make it empty and show the background (tileType = FREE). Used
-     * when loading level-layouts.
+     * Requests the KGoldrunner game to play or stop a sound.  The signal is
+     * relayed from the hero.
      *
-     * @param i            The column-number of the cell to paint.
-     * @param j            The row-number of the cell to paint.
-     * @param tileType     The type of tile to paint (gold, brick, ladder, etc).
+     * @param n            The sound to play (see enum in kgrglobals.h).
+     * @param onOff        True to play the sound: false to stop it.
      */
-    void paintCell      (int i, int j, char tileType);
-
-    int  makeSprite     (char spriteType, int i, int j);
+    void playSound      (const int n, const bool onOff);
 
     /**
-     * Requests the view to display an animation of a dug brick at a
-     * particular cell, cancelling and superseding any current animation.
+     * Tells the game (KGrGame) that a tick has been played back, so that it
+     * can show how far the replay has gone.
      *
-     * @param spriteId     The ID of the sprite (dug brick).
-     * @param repeating    If true, repeat the animation (false for dug brick).
-     * @param i            The column-number of the cell to dig.
-     * @param j            The row-number of the cell to dig.
-     * @param time         The time in which to traverse one cell.
-     * @param dirn         The direction of motion, always STAND.
-     * @param type         The type of animation (open or close the brick).
+     * @param tick         The tick reached (see tickCount()).
      */
-    void startAnimation (const int spriteId, const bool repeating,
-                         const int i, const int j, const int time,
-                         const Direction dirn, const AnimationType type);
+    void tickPlayed     (const int tick);
 
-    void deleteSprite   (const int spriteId);
-    void gotGold        (const int  spriteId, const int i, const int j,
-                         const bool hasGold, const bool lost);
-    void interruptDemo  ();
+public Q_SLOTS:
+    void doDig          (int button);	// Dig using mouse-buttons.
 
 private Q_SLOTS:
     /**
      * This slot powers the whole game. KGrLevelPlayer connects it to KGrTimer's
      * tick() signal. In this slot, KGrLevelPlayer EITHER plays back a recorded
      * tick OR checks the mouse/trackpad/keyboard for user-input, then processes
-     * dug bricks, moves the hero, moves the enemies and finally emits the
-     * animation() signal, which causes the view to update the screen.
+     * dug bricks, moves the hero, moves the enemies and finally calls the
+     * observer's animate() method, which causes the view to update the screen.
      *
      * @param missed       If true, the QTimer has missed one or more ticks, due
      *                     to overheads elsewhere in Qt or the O/S. The game
@@ -376,16 +569,44 @@ private Q_SLOTS:
      */
     void tick           (bool missed, int scaledTime);
 
-    void doDig          (int button);	// Dig using mouse-buttons.
-
 private:
-    KGrGame *            game;
+    // Do the work of tick() and return the result, with no endLevel() signal.
+    int                  playTick (const bool missed, const int scaledTime);
+
+    KGrLevelObserver *   observer;	// Where the level is displayed, via
+    KGrRenderBuffer      renderBuffer;	// a buffer of drawing requests.
     QRandomGenerator *   randomGen;
     KGrLevelGrid *       grid;
     KGrRuleBook *        rules;
     KGrHero *            hero;
     int                  heroId;
     QList<KGrEnemy *>    enemies;
+    KGrRunnerStore       runners;	// Positions etc. of hero and enemies.
+
+    // The IDs of the enemies in each grid-cell (i + j * width) and the cell
+    // where each enemy is (by ID - 1), as reserved by the enemies.
+    QList<QList<int> >   enemiesInCell;
+    QList<int>           enemyCell;
+    void                 nearbyCells (const int x, const int y,
+                                      int & iMin, int & iMax,
+                                      int & jMin, int & jMax);
+
+    // The enemies act only at some ticks and just wait at others, so each one
+    // is scheduled in a timing wheel (a list of enemy indices for each of a
+    // cycle of ticks) to be run only at the next tick when it is due to act.
+    QList<QList<int> >   wheel;
+    QList<int>           enemyDue;	// Tick at which each enemy is due.
+    QList<int>           enemyLastTick;	// Tick up to which each has waited.
+    int                  wheelTick;	// Count of ticks in which enemies run.
+    int                  wheelTime;	// Scaled time of the scheduled ticks.
+    void                 runEnemies (const int scaledTime);
+    void                 scheduleEnemy (const int index, const int fromTick);
+    void                 rescheduleEnemies (const int scaledTime);
+
+    int                  spriteCount;	// Number of sprite IDs issued so far.
+    QList<int>           freeSpriteIds;	// IDs of deleted dug-brick sprites.
+    int                  makeSprite (const char type, const int i, const int j);
+    void                 deleteSprite (const int spriteId);
 
     int                  controlMode;
     int                  holdKeyOption;
@@ -402,6 +623,7 @@ private:
     int                  recIndex;
     int                  recCount;
     int                  randIndex;
+    KGrRandom            random;	// Random numbers, if there is a seed.
 
     int                  targetI;	// Where the mouse is pointing.
     int                  targetJ;
@@ -411,6 +633,7 @@ private:
     Direction            direction;	// Direction for the hero to take.
     Direction            newDirection;	// Next direction for the hero to take.
     KGrTimer *           timer;		// The time-standard for the level.
+    int                  stepTime;	// Scaled time of one tick (msec).
 
     void startDigging (Direction diggingDirection);
     void processDugBricks (const int scaledTime);
@@ -434,21 +657,32 @@ private:
     } DugBrick;
 
     QList <DugBrick *> dugBricks;
+    quint64            dugHash;		// Hash of the dug bricks' countdowns.
+    static quint64     dugBrickKey (const DugBrick * dugBrick);
+
+    // Snapshots taken every KeyframeTicks ticks during playback, for seek().
+    QList<Snapshot>    keyframes;
+    int                seekLimit;	// Last tick seek() can reach, or -1.
+    void               takeKeyframe();
+    void               redrawLevel();
 
     int          reappearIndex;
     QList<int>   reappearPos;
     void         makeReappearanceSequence();
+    int          randomIndex (const int limit);
+    HeroStatus   runTick (const int scaledTime);
+    void         checkState();
+    int          divergence;		// See divergentTick().
     bool         doRecordedMove();
     void         recordInitialWaitTime (const int ms);
     void         record (const int bytes, const int n1, const int n2 = 0);
+    void         recordWideTarget (const int i, const int j);
 
 /******************************************************************************/
 /**************************  AUTHORS' DEBUGGING AIDS **************************/
 /******************************************************************************/
 
-    static int playerCount;
-
-    void bugFix();		// Turn a bug fix on/off dynamically.
+    void toggleBugFix();	// Turn a bug fix on/off dynamically.
     void startLogging();	// Turn logging on/off.
     void showFigurePositions();	// Show everybody's co-ordinates.
     void showObjectState();	// Show an object's state.
@@ -0,0 +1,139 @@
+/*
+    SPDX-FileCopyrightText: 2026 The KGoldrunner Developers
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#include "kgrnavfield.h"
+#include "kgrlevelgrid.h"
+
+KGrNavField::KGrNavField (KGrLevelGrid * pGrid)
+    :
+    grid   (pGrid),
+    width  (0),
+    height (0)
+{
+}
+
+KGrNavField::~KGrNavField()
+{
+}
+
+void KGrNavField::build()
+{
+    width  = grid->gridWidth();
+    height = grid->levelHeight() + 2 * ConcreteWall;
+    cells.fill (NavCell(), width * height);
+
+    for (int j = 1; j < height - 1; j++) {
+        for (int i = 1; i < width - 1; i++) {
+            cells [i + j * width].ladderUp = (grid->cellType (i, j) == LADDER) ?
+                        cells [i + (j - 1) * width].ladderUp + 1 : 0;
+        }
+        buildRow (j);
+    }
+}
+
+void KGrNavField::cellChanged (const int i, const int j)
+{
+    // The cell's type affects the ladders in its column, the searches and ways
+    // down in its row and, as a floor, the searches and ways down in the row
+    // above.
+    buildColumn (i, j);
+    buildRow (j);
+    if (j > 1) {
+        buildRow (j - 1);
+    }
+}
+
+void KGrNavField::buildColumn (const int i, const int j)
+{
+    // Count the ladders upwards, from row j down to where the counts below a
+    // changed cell stop changing.
+    for (int y = j; y < height - 1; y++) {
+        int rungs = (grid->cellType (i, y) == LADDER) ?
+                    cells [i + (y - 1) * width].ladderUp + 1 : 0;
+        NavCell & cell = cells [i + y * width];
+        if ((y > j) && (cell.ladderUp == rungs)) {
+            break;
+        }
+        cell.ladderUp = rungs;
+    }
+}
+
+void KGrNavField::buildRow (const int j)
+{
+    const int row = j * width;
+
+    // The cells in the wall are the limits when there is no ladder or way down.
+    cells [row].ladderL             = 0;
+    cells [row].dropL               = 0;
+    cells [row + width - 1].ladderR = width - 1;
+    cells [row + width - 1].dropR   = width - 1;
+
+    for (int i = 1; i < width - 1; i++) {
+        const NavCell & left = cells [row + i - 1];
+        NavCell & cell       = cells [row + i];
+        bool walk            = canStand (i, j) && (! isBlocked (i - 1, j));
+        cell.walkL           = walk ? left.walkL + 1 : 0;
+        cell.searchL         = (walk && canStand (i - 1, j)) ?
+                               left.searchL + 1 : 0;
+        cell.ladderL         = (grid->cellType (i, j) == LADDER) ?
+                               i : left.ladderL;
+        switch (grid->cellType (i, j + 1)) {
+        case BRICK:
+        case CONCRETE:
+        case HOLE:
+        case USEDHOLE:
+            cell.dropL       = left.dropL;	// Cannot go down through these.
+            break;
+        default:
+            cell.dropL       = i;
+            break;
+        }
+    }
+
+    for (int i = width - 2; i > 0; i--) {
+        const NavCell & right = cells [row + i + 1];
+        NavCell & cell        = cells [row + i];
+        bool walk             = canStand (i, j) && (! isBlocked (i + 1, j));
+        cell.walkR            = walk ? right.walkR + 1 : 0;
+        cell.searchR          = (walk && canStand (i + 1, j)) ?
+                                right.searchR + 1 : 0;
+        cell.ladderR          = (cell.ladderL == i) ? i : right.ladderR;
+        cell.dropR            = (cell.dropL == i) ? i : right.dropR;
+    }
+}
+
+bool KGrNavField::canStand (const int i, const int j)
+{
+    // As in KGrTraditionalRules::willNotFall(), but with no enemies to stand on.
+    switch (grid->cellType (i, j)) {
+    case LADDER:
+    case BAR:
+        return true;
+    default:
+        break;
+    }
+    switch (grid->cellType (i, j + 1)) {
+    case FREE:
+    case HLADDER:
+    case FBRICK:
+        return false;
+    default:
+        return true;
+    }
+}
+
+bool KGrNavField::isBlocked (const int i, const int j)
+{
+    // As in KGrTraditionalRules::canWalkLR().
+    switch (grid->cellType (i, j)) {
+    case CONCRETE:
+    case BRICK:
+    case USEDHOLE:
+        return true;
+    default:
+        return false;
+    }
+}
@@ -0,0 +1,101 @@
+/*
+    SPDX-FileCopyrightText: 2026 The KGoldrunner Developers
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#ifndef KGRNAVFIELD_H
+#define KGRNAVFIELD_H
+
+#include <QList>
+
+class KGrLevelGrid;
+
+/**
+ * The KGrNavField class holds tables that the Traditional rules use to find
+ * a way for an enemy to go, so that it need not scan the rows and columns of
+ * the grid, cell by cell, every time an enemy enters a cell.
+ *
+ * The tables depend only on the types of the cells, so they are built once per
+ * level, when the KGrLevelGrid is constructed, and are updated only around a
+ * cell that changes (see KGrLevelGrid::changeCellAt()).
+ * KGrLevelGrid::calculateAccess() does not build them again.  They ignore
+ * enemies: an enemy can be a floor for another enemy, but that can only make a
+ * search go further, so the rules use a table to jump to the first cell where
+ * an enemy might make a difference and then check that cell as they always
+ * did.
+ *
+ * The "search" tables count steps that KGrTraditionalRules::searchOK() would
+ * allow and the "walk" tables count steps that canWalkLR() would allow.  The
+ * "ladder" and "drop" tables give the nearest column to the left or right
+ * that has a ladder or a way down, or a column in the wall if there is none.
+ *
+ * @short   KGoldrunner Enemy Navigation Tables
+ */
+
+class KGrNavField
+{
+public:
+    explicit KGrNavField (KGrLevelGrid * pGrid = nullptr);
+    ~KGrNavField();
+
+    /**
+     * Build all the tables, for a new grid or after a change of size.
+     */
+    void build();
+
+    /**
+     * Update the tables after the type of a cell has changed.  Only the
+     * column of the cell and the row it is in and the row above are affected.
+     */
+    void cellChanged       (const int i, const int j);
+
+    /// Number of LADDER cells from (i, j) upwards, or 0 if (i, j) is not one.
+    inline int ladderUp    (int i, int j) const { return at (i, j).ladderUp;   }
+
+    /// Number of steps left (right) from (i, j) that searchOK() must allow.
+    inline int searchLeft  (int i, int j) const { return at (i, j).searchL;    }
+    inline int searchRight (int i, int j) const { return at (i, j).searchR;    }
+
+    /// Number of steps left (right) from (i, j) that canWalkLR() must allow.
+    inline int walkLeft    (int i, int j) const { return at (i, j).walkL;      }
+    inline int walkRight   (int i, int j) const { return at (i, j).walkR;      }
+
+    /// Nearest column at or left (right) of i with a LADDER in row j.
+    inline int ladderLeft  (int i, int j) const { return at (i, j).ladderL;    }
+    inline int ladderRight (int i, int j) const { return at (i, j).ladderR;    }
+
+    /// Nearest column at or left (right) of i where an enemy might go down.
+    inline int dropLeft    (int i, int j) const { return at (i, j).dropL;      }
+    inline int dropRight   (int i, int j) const { return at (i, j).dropR;      }
+
+private:
+    typedef struct {
+        int ladderUp;
+        int searchL;
+        int searchR;
+        int walkL;
+        int walkR;
+        int ladderL;
+        int ladderR;
+        int dropL;
+        int dropR;
+    } NavCell;
+
+    inline const NavCell & at (int i, int j) const {
+        return cells [i + j * width];
+    }
+
+    void buildColumn (const int i, const int j);
+    void buildRow    (const int j);
+
+    bool canStand    (const int i, const int j);
+    bool isBlocked   (const int i, const int j);
+
+    KGrLevelGrid *   grid;
+    int              width;
+    int              height;
+    QList<NavCell>   cells;
+};
+
+#endif // KGRNAVFIELD_H
@@ -0,0 +1,55 @@
+/*
+    SPDX-FileCopyrightText: 2026 The KGoldrunner Developers
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#ifndef KGRRANDOM_H
+#define KGRRANDOM_H
+
+#include <QtGlobal>
+
+/**
+ * The KGrRandom class generates the random numbers for a recording that has a
+ * seed (see KGrRecording::seed), so that the numbers need not be stored in the
+ * recording.  The sequence is fixed by this code alone, not by Qt or the C++
+ * library, so a recording replays the same on every platform and in every
+ * future version of KGoldrunner.  It must never be changed.
+ *
+ * The generator is SplitMix64: the state goes up by a constant on each call
+ * and is mixed into a 64-bit result.  A number below a limit is the top 32
+ * bits of the result, multiplied by the limit and divided by 2^32.
+ *
+ * @short   KGoldrunner Portable Random Numbers
+ */
+
+class KGrRandom
+{
+public:
+    /// The seed used by KGrSolver and KGrEnvironment if a level has none, so
+    /// that they play the same unseeded level in the same way.
+    static constexpr quint64 DefaultSeed = Q_UINT64_C(0x4b47724b47724b47);
+
+    explicit KGrRandom (const quint64 seed = 0) : state (seed) {}
+
+    /// Start the sequence for a given seed.
+    inline void seed (const quint64 seed) { state = seed; }
+
+    /// Return the next 64-bit number in the sequence.
+    inline quint64 next() {
+        quint64 z = (state += Q_UINT64_C(0x9e3779b97f4a7c15));
+        z = (z ^ (z >> 30)) * Q_UINT64_C(0xbf58476d1ce4e5b9);
+        z = (z ^ (z >> 27)) * Q_UINT64_C(0x94d049bb133111eb);
+        return z ^ (z >> 31);
+    }
+
+    /// Return the next number in the sequence, >= 0 and < limit.
+    inline uchar bounded (const uchar limit) {
+        return (uchar) (((next() >> 32) * limit) >> 32);
+    }
+
+private:
+    quint64 state;
+};
+
+#endif // KGRRANDOM_H
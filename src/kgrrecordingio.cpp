@@ -0,0 +1,607 @@
+/*
+    SPDX-FileCopyrightText: 2026 The KGoldrunner Developers
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#include "kgrrecordingio.h"
+#include "kgoldrunner_debug.h"
+
+#include <QFile>
+#include <QFileInfo>
+#include <QList>
+#include <QSaveFile>
+#include <QtEndian>
+
+#include <KConfig>
+#include <KConfigGroup>
+
+#include <climits>
+#include <cstring>
+
+static const char    BinaryMagic [4] = {'K', 'G', 'R', 'R'};
+static const quint16 BinaryVersion   = 1;
+static const int     BinaryHeaderSize = 6;	// Magic code and version.
+
+namespace {
+
+// Reads little-endian fields from a record, with checks against overruns.
+class RecordReader
+{
+public:
+    RecordReader (const uchar * data, const int size)
+        : p (data), end (data + size), ok (true) {}
+
+    bool check (const qint64 n) {
+        ok = ok && (n >= 0) && (n <= (end - p));
+        return ok;
+    }
+    quint8  u8()  {
+        if (! check (1)) return 0;
+        return *p++;
+    }
+    quint16 u16() {
+        if (! check (2)) return 0;
+        quint16 v = qFromLittleEndian<quint16> (p); p += 2; return v;
+    }
+    quint32 u32() {
+        if (! check (4)) return 0;
+        quint32 v = qFromLittleEndian<quint32> (p); p += 4; return v;
+    }
+    quint64 u64() {
+        if (! check (8)) return 0;
+        quint64 v = qFromLittleEndian<quint64> (p); p += 8; return v;
+    }
+    qint32  i32() { return (qint32) u32(); }
+    const uchar * bytes (const quint32 n) {
+        if (! check (n)) return nullptr;
+        const uchar * b = p; p += n; return b;
+    }
+    QByteArray byteArray() {
+        quint32 n = u32();
+        const uchar * b = bytes (n);
+        return ok ? QByteArray ((const char *) b, n) : QByteArray();
+    }
+    QString string() {
+        quint32 n = u32();
+        const uchar * b = bytes (n);
+        return ok ? QString::fromUtf8 ((const char *) b, n) : QString();
+    }
+    // Decode a run-length encoded stream into a zero-terminated buffer.
+    void runs (QByteArray & buffer) {
+        quint32 size    = u32();
+        quint32 encoded = u32();
+        const uchar * b = bytes (encoded);
+        if (! ok) return;
+        // PackBits expands at most 64 times (2 bytes to 128), so any larger
+        // size is damage and must not be allocated.
+        if ((size > (quint64) encoded * 64) || (size >= (quint32) INT_MAX)) {
+            ok = false;
+            return;
+        }
+        buffer.fill (0, size + 1);
+        ok = KGrRecordingIO::decodeRuns (b, encoded, buffer.data(), size);
+    }
+
+    const uchar * p;
+    const uchar * end;
+    bool          ok;
+};
+
+void putU8  (QByteArray & out, const quint8 v)  { out.append ((char) v); }
+void putU16 (QByteArray & out, const quint16 v) {
+    char b [2]; qToLittleEndian<quint16> (v, b); out.append (b, 2);
+}
+void putU32 (QByteArray & out, const quint32 v) {
+    char b [4]; qToLittleEndian<quint32> (v, b); out.append (b, 4);
+}
+void putU64 (QByteArray & out, const quint64 v) {
+    char b [8]; qToLittleEndian<quint64> (v, b); out.append (b, 8);
+}
+void putBytes (QByteArray & out, const QByteArray & bytes) {
+    putU32 (out, bytes.size()); out.append (bytes);
+}
+void putString (QByteArray & out, const QString & s) {
+    putBytes (out, s.toUtf8());
+}
+// Run-length encode the bytes of a stream up to (not including) the first zero.
+void putRuns (QByteArray & out, const QByteArray & stream) {
+    int size = stream.indexOf ('\0');
+    if (size < 0) {
+        size = stream.size();
+    }
+    QByteArray encoded;
+    KGrRecordingIO::encodeRuns (stream.constData(), size, encoded);
+    putU32 (out, size);
+    putBytes (out, encoded);
+}
+
+// Find the records in a binary file, or return false if it is not valid.
+bool findRecords (const QByteArray & file, QStringList & groups,
+                  QList<QByteArray> & records)
+{
+    if ((file.size() < BinaryHeaderSize) ||
+        (! file.startsWith (QByteArray (BinaryMagic, 4)))) {
+        return false;
+    }
+    RecordReader header ((const uchar *) file.constData() + 4, 2);
+    if (header.u16() > BinaryVersion) {
+        qCWarning(KGOLDRUNNER_LOG) << "Recording file version is too new.";
+        return false;
+    }
+    RecordReader in ((const uchar *) file.constData() + BinaryHeaderSize,
+                     file.size() - BinaryHeaderSize);
+    while (in.ok && (in.p < in.end)) {
+        quint32 length = in.u32();
+        const uchar * record = in.bytes (length);
+        if (! in.ok) {
+            break;
+        }
+        RecordReader r (record, length);
+        groups << r.string();
+        records << QByteArray ((const char *) record, length);
+    }
+    return in.ok;
+}
+
+// Decode the fields of a record that follow the group name.
+bool getRecord (RecordReader & r, KGrRecording * recording)
+{
+    recording->dateTime         = r.string();
+    recording->owner            = (Owner) r.u8();
+    recording->rules            = (char) r.u8();
+    recording->prefix           = r.string();
+    recording->gameName         = r.string();
+    recording->level            = r.i32();
+    recording->width            = r.u16();
+    recording->height           = r.u16();
+    recording->layout           = r.byteArray();
+    recording->levelName        = r.string();
+    recording->hint             = r.string();
+    recording->digWhileFalling  = (r.u8() != 0);
+    recording->lives            = r.i32();
+    recording->score            = r.i32();
+    recording->speed            = r.u8();
+    recording->controlMode      = r.u8();
+    recording->keyOption        = r.u8();
+    r.runs (recording->content);
+    r.runs (recording->draws);
+
+    // Older records end here, without any state checksums or random seed.
+    recording->checks.clear();
+    recording->seed = 0;
+    int checksVersion = 0;
+    if (r.ok && (r.p < r.end)) {
+        recording->checks = r.byteArray();
+    }
+    if (r.ok && (r.p < r.end)) {
+        recording->seed = r.u64();
+    }
+    if (r.ok && (r.p < r.end)) {
+        checksVersion = r.u16();
+    }
+    if (checksVersion != ChecksVersion) {
+        recording->checks.clear();	// Not comparable with new checksums.
+    }
+    return r.ok;
+}
+
+} // namespace
+
+bool KGrRecordingIO::isBinary (const QString & filePath)
+{
+    return filePath.endsWith (QLatin1String(".kgrec"));
+}
+
+QString KGrRecordingIO::binaryName (const QString & filePath)
+{
+    QString name = filePath;
+    if (name.endsWith (QLatin1String(".txt"))) {
+        name.chop (4);
+    }
+    return name + QLatin1String(".kgrec");
+}
+
+QStringList KGrRecordingIO::groupList (const QString & filePath)
+{
+    QStringList groups;
+    if (isBinary (filePath)) {
+        QFile file (filePath);
+        QList<QByteArray> records;
+        if (file.open (QIODevice::ReadOnly)) {
+            findRecords (file.readAll(), groups, records);
+        }
+    }
+    else {
+        KConfig config (filePath, KConfig::SimpleConfig);
+        groups = config.groupList();
+    }
+    return groups;
+}
+
+bool KGrRecordingIO::read (const QString & filePath, const QString & groupName,
+                           KGrRecording * recording)
+{
+    return isBinary (filePath) ?
+               readBinary (filePath, groupName, recording) :
+               readText   (filePath, groupName, recording);
+}
+
+bool KGrRecordingIO::write (const QString & filePath, const QString & groupName,
+                            const KGrRecording * recording)
+{
+    return isBinary (filePath) ?
+               writeBinary (filePath, groupName, recording) :
+               writeText   (filePath, groupName, recording);
+}
+
+bool KGrRecordingIO::readFile (const QString & filePath, QStringList & groups,
+                               QList<KGrRecording> & recordings)
+{
+    groups.clear();
+    recordings.clear();
+    if (! isBinary (filePath)) {
+        // KConfig would read a missing file as one with no groups.
+        QFileInfo fileInfo (filePath);
+        if ((! fileInfo.exists()) || (! fileInfo.isReadable())) {
+            return false;
+        }
+        // Parse the text file only once.
+        KConfig config (filePath, KConfig::SimpleConfig);
+        groups = config.groupList();
+        recordings.resize (groups.count());
+        for (int n = 0; n < groups.count(); n++) {
+            readGroup (config.group (groups.at (n)), &recordings [n]);
+        }
+        return true;
+    }
+
+    QFile file (filePath);
+    QList<QByteArray> records;
+    if ((! file.open (QIODevice::ReadOnly)) ||
+        (! findRecords (file.readAll(), groups, records))) {
+        return false;
+    }
+    recordings.resize (records.count());
+    for (int n = 0; n < records.count(); n++) {
+        RecordReader r ((const uchar *) records.at (n).constData(),
+                        records.at (n).size());
+        r.string();				// Skip the group name.
+        if (! getRecord (r, &recordings [n])) {
+            qCWarning(KGOLDRUNNER_LOG) << filePath << groups.at (n)
+                                       << "is damaged";
+            return false;
+        }
+    }
+    return true;
+}
+
+int KGrRecordingIO::convert (const QString & textPath,
+                             const QString & binaryPath)
+{
+    QStringList         groups;
+    QList<KGrRecording> recordings;
+    if (! readFile (textPath, groups, recordings)) {
+        return -1;
+    }
+
+    QByteArray out (BinaryMagic, 4);
+    putU16 (out, BinaryVersion);
+    for (int n = 0; n < groups.count(); n++) {
+        putRecord (out, groups.at (n), &recordings.at (n));
+    }
+
+    QSaveFile file (binaryPath);
+    if ((! file.open (QIODevice::WriteOnly)) || (file.write (out) < 0) ||
+        (! file.commit())) {
+        return -1;
+    }
+    return groups.count();
+}
+
+void KGrRecordingIO::encodeRuns (const char * data, const int size,
+                                 QByteArray & out)
+{
+    out.clear();
+    out.reserve (size + (size / 128) + 1);
+    int i = 0;
+    while (i < size) {
+        // Measure the run of identical bytes starting here.
+        int run = 1;
+        while (((i + run) < size) && (run < 128) &&
+               (data [i + run] == data [i])) {
+            run++;
+        }
+        if (run >= 3) {
+            out.append ((char) (257 - run));
+            out.append (data [i]);
+            i = i + run;
+            continue;
+        }
+
+        // Collect literal bytes until a run of 3 or more starts.
+        int start = i;
+        while ((i < size) && ((i - start) < 128)) {
+            if (((i + 2) < size) &&
+                (data [i] == data [i + 1]) && (data [i] == data [i + 2])) {
+                break;
+            }
+            i++;
+        }
+        out.append ((char) (i - start - 1));
+        out.append (data + start, i - start);
+    }
+}
+
+bool KGrRecordingIO::decodeRuns (const uchar * data, const int size,
+                                 char * out, const int outSize)
+{
+    const uchar * end = data + size;
+    int n = 0;
+    while (data < end) {
+        int c = *data++;
+        if (c < 128) {
+            int count = c + 1;
+            if (((end - data) < count) || ((n + count) > outSize)) {
+                return false;
+            }
+            memcpy (out + n, data, count);
+            data = data + count;
+            n    = n + count;
+        }
+        else if (c > 128) {
+            int count = 257 - c;
+            if ((data >= end) || ((n + count) > outSize)) {
+                return false;
+            }
+            memset (out + n, *data++, count);
+            n    = n + count;
+        }
+    }
+    return (n == outSize);
+}
+
+bool KGrRecordingIO::readText (const QString & filePath,
+                               const QString & groupName,
+                               KGrRecording * recording)
+{
+    KConfig config (filePath, KConfig::SimpleConfig);
+    if (! config.hasGroup (groupName)) {
+        qCDebug(KGOLDRUNNER_LOG) << "Group" << groupName << "NOT FOUND";
+        return false;
+    }
+    readGroup (config.group (groupName), recording);
+    return true;
+}
+
+void KGrRecordingIO::readGroup (const KConfigGroup & configGroup,
+                                KGrRecording * recording)
+{
+    QString blank;
+    recording->dateTime         = configGroup.readEntry ("DateTime", "");
+    recording->owner            = (Owner)(configGroup.readEntry
+                                                        ("Owner", (int)(USER)));
+    recording->rules            = configGroup.readEntry ("Rules", (int)('T'));
+    recording->prefix           = configGroup.readEntry ("Prefix", "");
+    recording->gameName         = configGroup.readEntry ("GameName", blank);
+    recording->level            = configGroup.readEntry ("Level",  1);
+    recording->width            = configGroup.readEntry ("Width",  FIELDWIDTH);
+    recording->height           = configGroup.readEntry ("Height", FIELDHEIGHT);
+    recording->layout           = configGroup.readEntry ("Layout", QByteArray());
+    recording->levelName        = configGroup.readEntry ("Name",   blank);
+    recording->hint             = configGroup.readEntry ("Hint",   blank);
+    recording->digWhileFalling  = configGroup.readEntry ("DigWhileFalling",
+                                                             true);
+    recording->lives            = configGroup.readEntry ("Lives",  5);
+    recording->score            = configGroup.readEntry ("Score",  0);
+    recording->speed            = configGroup.readEntry ("Speed",  10);
+    recording->controlMode      = configGroup.readEntry ("Mode",   (int)MOUSE);
+    recording->keyOption        = configGroup.readEntry ("KeyOption",
+                                                                (int)CLICK_KEY);
+
+    QList<int> bytes = configGroup.readEntry ("Content", QList<int>());
+    int n  = bytes.count();
+    recording->content.fill (0, n + 1);
+    for (int i = 0; i < n; i++) {
+        recording->content [i] = bytes.at (i);
+    }
+
+    bytes.clear();
+    bytes = configGroup.readEntry ("Draws", QList<int>());
+    n  = bytes.count();
+    recording->draws.fill (0, n + 1);
+    for (int i = 0; i < n; i++) {
+        recording->draws [i] = bytes.at (i);
+    }
+
+    recording->checks = QByteArray::fromHex
+                            (configGroup.readEntry ("Checks", QByteArray()));
+    if (configGroup.readEntry ("ChecksVersion", 0) != ChecksVersion) {
+        recording->checks.clear();	// Not comparable with new checksums.
+    }
+    recording->seed   = configGroup.readEntry ("Seed", QString())
+                                                    .toULongLong (nullptr, 16);
+}
+
+bool KGrRecordingIO::writeText (const QString & filePath,
+                                const QString & groupName,
+                                const KGrRecording * recording)
+{
+    KConfig config (filePath, KConfig::SimpleConfig);
+    KConfigGroup configGroup = config.group (groupName);
+    configGroup.writeEntry ("DateTime", recording->dateTime);
+    configGroup.writeEntry ("Owner",    (int) recording->owner);
+    configGroup.writeEntry ("Rules",    (int) recording->rules);
+    configGroup.writeEntry ("Prefix",   recording->prefix);
+    configGroup.writeEntry ("GameName", recording->gameName);
+    configGroup.writeEntry ("Level",    recording->level);
+    configGroup.writeEntry ("Width",    recording->width);
+    configGroup.writeEntry ("Height",   recording->height);
+    configGroup.writeEntry ("Layout",   recording->layout);
+    configGroup.writeEntry ("Name",     recording->levelName);
+    configGroup.writeEntry ("Hint",     recording->hint);
+    configGroup.writeEntry ("DigWhileFalling", recording->digWhileFalling);
+    configGroup.writeEntry ("Lives",    (int) recording->lives);
+    configGroup.writeEntry ("Score",    (int) recording->score);
+    configGroup.writeEntry ("Speed",    (int) recording->speed);
+    configGroup.writeEntry ("Mode",     (int) recording->controlMode);
+    configGroup.writeEntry ("KeyOption", (int)recording->keyOption);
+
+    QList<int> bytes;
+    int ch = 0;
+    int n  = recording->content.size();
+    for (int i = 0; i < n; i++) {
+        ch = (uchar)(recording->content.at(i));
+        bytes.append (ch);
+        if (ch == 0)
+            break;
+    }
+    configGroup.writeEntry ("Content", bytes);
+
+    bytes.clear();
+    ch = 0;
+    n = recording->draws.size();
+    for (int i = 0; i < n; i++) {
+        ch = (uchar)(recording->draws.at(i));
+        bytes.append (ch);
+        if (ch == 0)
+            break;
+    }
+    configGroup.writeEntry ("Draws", bytes);
+
+    if (recording->checks.isEmpty()) {
+        configGroup.deleteEntry ("Checks");
+        configGroup.deleteEntry ("ChecksVersion");
+    }
+    else {
+        configGroup.writeEntry ("Checks", recording->checks.toHex());
+        configGroup.writeEntry ("ChecksVersion", ChecksVersion);
+    }
+
+    if (recording->seed == 0) {
+        configGroup.deleteEntry ("Seed");
+    }
+    else {
+        configGroup.writeEntry ("Seed", QString::number (recording->seed, 16));
+    }
+
+    configGroup.sync();			// Ensure that the entry goes to disk.
+    return true;
+}
+
+bool KGrRecordingIO::readBinary (const QString & filePath,
+                                 const QString & groupName,
+                                 KGrRecording * recording)
+{
+    QFile file (filePath);
+    if (! file.open (QIODevice::ReadOnly)) {
+        return false;
+    }
+    const QByteArray data = file.readAll();
+    if ((data.size() < BinaryHeaderSize) ||
+        (! data.startsWith (QByteArray (BinaryMagic, 4)))) {
+        qCDebug(KGOLDRUNNER_LOG) << filePath << "is not a recording file";
+        return false;
+    }
+    RecordReader header ((const uchar *) data.constData() + 4, 2);
+    if (header.u16() > BinaryVersion) {
+        qCWarning(KGOLDRUNNER_LOG) << filePath << "version is too new";
+        return false;
+    }
+
+    // Skip the records of other levels, without decoding them.
+    const QByteArray group = groupName.toUtf8();
+    RecordReader in ((const uchar *) data.constData() + BinaryHeaderSize,
+                     data.size() - BinaryHeaderSize);
+    while (in.ok && (in.p < in.end)) {
+        quint32 length = in.u32();
+        const uchar * record = in.bytes (length);
+        if (! in.ok) {
+            break;
+        }
+        RecordReader r (record, length);
+        quint32 nameLength = r.u32();
+        const uchar * name = r.bytes (nameLength);
+        if ((! r.ok) || (nameLength != (quint32) group.size()) ||
+            (memcmp (name, group.constData(), nameLength) != 0)) {
+            continue;
+        }
+
+        if (! getRecord (r, recording)) {
+            qCWarning(KGOLDRUNNER_LOG) << filePath << groupName << "is damaged";
+        }
+        return r.ok;
+    }
+    qCDebug(KGOLDRUNNER_LOG) << "Group" << groupName << "NOT FOUND";
+    return false;
+}
+
+bool KGrRecordingIO::writeBinary (const QString & filePath,
+                                  const QString & groupName,
+                                  const KGrRecording * recording)
+{
+    // Keep the other levels that are on the file already.
+    QStringList       groups;
+    QList<QByteArray> records;
+    QFile oldFile (filePath);
+    if (oldFile.open (QIODevice::ReadOnly)) {
+        if (! findRecords (oldFile.readAll(), groups, records)) {
+            qCWarning(KGOLDRUNNER_LOG) << filePath << "is not a recording file";
+            return false;
+        }
+        oldFile.close();
+    }
+
+    QByteArray newRecord;
+    putRecord (newRecord, groupName, recording);
+    int index = groups.indexOf (groupName);
+    if (index >= 0) {
+        records [index] = newRecord.mid (4);	// Replace the old recording.
+    }
+    else {
+        records.append (newRecord.mid (4));	// Add a new recording.
+    }
+
+    QByteArray out (BinaryMagic, 4);
+    putU16 (out, BinaryVersion);
+    for (const QByteArray & record : std::as_const(records)) {
+        putU32 (out, record.size());
+        out.append (record);
+    }
+
+    QSaveFile file (filePath);
+    return file.open (QIODevice::WriteOnly) && (file.write (out) >= 0) &&
+           file.commit();
+}
+
+void KGrRecordingIO::putRecord (QByteArray & out, const QString & group,
+                                const KGrRecording * recording)
+{
+    QByteArray r;
+    putString (r, group);
+    putString (r, recording->dateTime);
+    putU8     (r, recording->owner);
+    putU8     (r, recording->rules);
+    putString (r, recording->prefix);
+    putString (r, recording->gameName);
+    putU32    (r, recording->level);
+    putU16    (r, recording->width);
+    putU16    (r, recording->height);
+    putBytes  (r, recording->layout);
+    putString (r, recording->levelName);
+    putString (r, recording->hint);
+    putU8     (r, recording->digWhileFalling ? 1 : 0);
+    putU32    (r, recording->lives);
+    putU32    (r, recording->score);
+    putU8     (r, recording->speed);
+    putU8     (r, recording->controlMode);
+    putU8     (r, recording->keyOption);
+    putRuns   (r, recording->content);
+    putRuns   (r, recording->draws);
+    putBytes  (r, recording->checks);
+    putU64    (r, recording->seed);
+    putU16    (r, ChecksVersion);
+
+    putU32    (out, r.size());		// The length comes first.
+    out.append (r);
+}
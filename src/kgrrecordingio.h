@@ -0,0 +1,147 @@
+/*
+    SPDX-FileCopyrightText: 2026 The KGoldrunner Developers
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#ifndef KGRRECORDINGIO_H
+#define KGRRECORDINGIO_H
+
+#include "kgrglobals.h"
+
+#include <QList>
+#include <QStringList>
+
+class KConfigGroup;
+
+/**
+ * The KGrRecordingIO class reads and writes files of recorded play, such as
+ * rec_<prefix> and sol_<prefix>, in either of two formats.
+ *
+ * The text format (file-type ".txt") is a KConfig file, with one group per
+ * level (e.g. [plws012]) and with the content and random draws written as
+ * lists of integers and the state checksums and random seed, if any, written
+ * in hex, with the version of the checksums (see ChecksVersion).  It is used
+ * by all older versions of KGoldrunner and for the demos and solutions that
+ * are released with KGoldrunner.
+ *
+ * The binary format (file-type ".kgrec") starts with a 4-byte magic code
+ * "KGRR" and a 16-bit version number, followed by one record per level.  Each
+ * record starts with its length, so records that are not wanted can be
+ * skipped without decoding them.  Then come the group name, the KGrRecording
+ * fields (strings as UTF-8) and the content and draws, which are run-length
+ * encoded in PackBits form, and last the state checksums, the 64-bit seed
+ * of the random numbers and the 16-bit version of the checksums, which older
+ * records do not have.  All integers are little-endian.  Reading a record
+ * decodes the bytes directly into the KGrRecording buffers.  In either format,
+ * checksums of another version are dropped on reading.
+ *
+ * @short   KGoldrunner Recording-File IO
+ */
+
+class KGrRecordingIO
+{
+public:
+    /**
+     * Return true if the file-name has the file-type of the binary format.
+     */
+    static bool        isBinary     (const QString & filePath);
+
+    /**
+     * Change the file-type of a file-name to that of the binary format.
+     */
+    static QString     binaryName   (const QString & filePath);
+
+    /**
+     * Find the names of the recorded levels on a file (e.g. "plws012"), in
+     * the order in which they occur.  Either format can be used.
+     */
+    static QStringList groupList    (const QString & filePath);
+
+    /**
+     * Read one recorded level from a file in either format.  The content and
+     * draws are followed by a zero byte, as KGrLevelPlayer requires.
+     *
+     * @param filePath   The file to read.
+     * @param groupName  The name of the recorded level (e.g. "plws012").
+     * @param recording  The object to receive the data.
+     *
+     * @return           True if the level was found and read correctly.
+     */
+    static bool        read         (const QString & filePath,
+                                     const QString & groupName,
+                                     KGrRecording * recording);
+
+    /**
+     * Read all the recorded levels on a file in either format, in the order
+     * in which they occur.  The file is read and parsed only once.
+     *
+     * @param filePath   The file to read.
+     * @param groups     The names of the recorded levels (return by ref).
+     * @param recordings The recorded levels (return by reference).
+     *
+     * @return           True if the whole file was read correctly.
+     */
+    static bool        readFile     (const QString & filePath,
+                                     QStringList & groups,
+                                     QList<KGrRecording> & recordings);
+
+    /**
+     * Write one recorded level to a file in either format, replacing any
+     * previous recording of the same level or adding a new one at the end.
+     *
+     * @return           True if the file was written correctly.
+     */
+    static bool        write        (const QString & filePath,
+                                     const QString & groupName,
+                                     const KGrRecording * recording);
+
+    /**
+     * Convert a whole file of recordings from the text format to the binary
+     * format, keeping the order of the levels.
+     *
+     * @return           The number of levels converted, or -1 if the text
+     *                   file is missing or unreadable or the binary file
+     *                   could not be written.
+     */
+    static int         convert      (const QString & textPath,
+                                     const QString & binaryPath);
+
+    /**
+     * Encode bytes in PackBits form.  A control byte n from 0 to 127 is
+     * followed by n + 1 literal bytes.  A control byte n from 129 to 255 is
+     * followed by one byte, to be repeated 257 - n times.
+     */
+    static void        encodeRuns   (const char * data, const int size,
+                                     QByteArray & out);
+
+    /**
+     * Decode bytes in PackBits form, into a buffer of known size.
+     *
+     * @return           True if exactly outSize bytes were decoded.
+     */
+    static bool        decodeRuns   (const uchar * data, const int size,
+                                     char * out, const int outSize);
+
+private:
+    static bool        readText     (const QString & filePath,
+                                     const QString & groupName,
+                                     KGrRecording * recording);
+    static void        readGroup    (const KConfigGroup & configGroup,
+                                     KGrRecording * recording);
+    static bool        writeText    (const QString & filePath,
+                                     const QString & groupName,
+                                     const KGrRecording * recording);
+
+    static bool        readBinary   (const QString & filePath,
+                                     const QString & groupName,
+                                     KGrRecording * recording);
+    static bool        writeBinary  (const QString & filePath,
+                                     const QString & groupName,
+                                     const KGrRecording * recording);
+
+    static void        putRecord    (QByteArray & out, const QString & group,
+                                     const KGrRecording * recording);
+};
+
+#endif // KGRRECORDINGIO_H
@@ -0,0 +1,163 @@
+/*
+    SPDX-FileCopyrightText: 2026 The KGoldrunner Developers
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#include "kgrrenderbuffer.h"
+
+KGrRenderBuffer::KGrRenderBuffer (KGrLevelObserver * pView)
+    :
+    view (pView)
+{
+}
+
+KGrRenderBuffer::~KGrRenderBuffer()
+{
+}
+
+void KGrRenderBuffer::flush()
+{
+    if (commands.isEmpty()) {
+        return;
+    }
+    if (! view) {
+        commands.clear();
+        ladderLists.clear();
+        return;
+    }
+
+    for (const Command & c : std::as_const(commands)) {
+        switch (c.request) {
+        case PaintCell:
+            view->paintCell (c.i, c.j, c.type);
+            break;
+        case MakeSprite:
+            view->makeSprite (c.spriteId, c.type, c.i, c.j);
+            break;
+        case StartAnimation:
+            view->startAnimation (c.spriteId, c.flag1, c.i, c.j, c.time,
+                                  c.dirn, c.animation);
+            break;
+        case DeleteSprite:
+            view->deleteSprite (c.spriteId);
+            break;
+        case GotGold:
+            view->gotGold (c.spriteId, c.i, c.j, c.flag1, c.flag2);
+            break;
+        case ShowHiddenLadders:
+            view->showHiddenLadders (ladderLists.at (c.spriteId), c.time);
+            break;
+        }
+    }
+
+    // Empty the buffer, but keep the memory for the next tick.
+    commands.clear();
+    ladderLists.clear();
+}
+
+void KGrRenderBuffer::append (const Request request, const int spriteId,
+                              const int i, const int j)
+{
+    Command c;
+    c.request   = request;
+    c.spriteId  = spriteId;
+    c.i         = i;
+    c.j         = j;
+    c.time      = 0;
+    c.type      = FREE;
+    c.flag1     = false;
+    c.flag2     = false;
+    c.dirn      = STAND;
+    c.animation = FALL_L;
+    commands.append (c);
+}
+
+void KGrRenderBuffer::setGoldEnemiesRule (bool showIt)
+{
+    flush();
+    if (view) {
+        view->setGoldEnemiesRule (showIt);
+    }
+}
+
+void KGrRenderBuffer::setGridSize (const int width, const int height)
+{
+    flush();
+    if (view) {
+        view->setGridSize (width, height);
+    }
+}
+
+void KGrRenderBuffer::paintCell (const int i, const int j, const char type)
+{
+    append (PaintCell, -1, i, j);
+    commands.last().type = type;
+}
+
+void KGrRenderBuffer::makeSprite (const int spriteId, const char type,
+                                  int i, int j)
+{
+    append (MakeSprite, spriteId, i, j);
+    commands.last().type = type;
+}
+
+void KGrRenderBuffer::startAnimation (const int spriteId, const bool repeating,
+                                      const int i, const int j, const int time,
+                                      const Direction dirn,
+                                      const AnimationType type)
+{
+    append (StartAnimation, spriteId, i, j);
+    Command & c = commands.last();
+    c.flag1     = repeating;
+    c.time      = time;
+    c.dirn      = dirn;
+    c.animation = type;
+}
+
+void KGrRenderBuffer::deleteSprite (const int spriteId)
+{
+    append (DeleteSprite, spriteId, 0, 0);
+}
+
+void KGrRenderBuffer::gotGold (const int spriteId, const int i, const int j,
+                               const bool hasGold, const bool lost)
+{
+    append (GotGold, spriteId, i, j);
+    Command & c = commands.last();
+    c.flag1     = hasGold;
+    c.flag2     = lost;
+}
+
+void KGrRenderBuffer::showHiddenLadders (const QList<int> & ladders,
+                                         const int width)
+{
+    append (ShowHiddenLadders, ladderLists.count(), 0, 0);
+    commands.last().time = width;
+    ladderLists.append (ladders);
+}
+
+void KGrRenderBuffer::animate (bool missed)
+{
+    flush();
+    if (view) {
+        view->animate (missed);
+    }
+}
+
+void KGrRenderBuffer::getMousePos (int & i, int & j)
+{
+    if (view) {
+        view->getMousePos (i, j);
+    }
+    else {
+        KGrLevelObserver::getMousePos (i, j);
+    }
+}
+
+void KGrRenderBuffer::setMousePos (const int i, const int j)
+{
+    if (view) {
+        view->setMousePos (i, j);
+    }
+}
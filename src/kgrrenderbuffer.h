@@ -0,0 +1,96 @@
+/*
+    SPDX-FileCopyrightText: 2026 The KGoldrunner Developers
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#ifndef KGRRENDERBUFFER_H
+#define KGRRENDERBUFFER_H
+
+#include "kgrlevelobserver.h"
+
+#include <QList>
+
+/**
+ * @short Buffer of drawing requests between the game-engine and the view
+ *
+ * KGrLevelPlayer, KGrHero and KGrEnemy send their drawing requests (paint a
+ * cell, start an animation, etc.) to this buffer, which keeps them in a list
+ * until the end of the tick.  Then animate() passes them all to the view (e.g.
+ * KGrScene), in the order in which they were made, followed by the view's own
+ * animate().  So the view's graphics items are never changed in the middle of
+ * a tick's moves and the rules can run without the view between the drawing
+ * requests.  Requests made outside a tick (e.g. when setting up the level or
+ * digging in response to a key or mouse button) are passed on by calling
+ * flush() at the end of the KGrLevelPlayer method that made them, so that
+ * they are not held up until the next tick (e.g. while the game is paused).
+ *
+ * Questions about the pointer, and requests that affect how later requests are
+ * shown (the size of the grid and the gold-showing rule), are passed on at
+ * once, after any requests already in the buffer.
+ */
+class KGrRenderBuffer : public KGrLevelObserver
+{
+public:
+    explicit KGrRenderBuffer (KGrLevelObserver * pView = nullptr);
+    ~KGrRenderBuffer() override;
+
+    /**
+     * Sets the view to which the requests are passed.
+     */
+    inline void setView (KGrLevelObserver * pView) { view = pView; }
+
+    /**
+     * Returns the view to which the requests are passed (or nullptr).
+     */
+    inline KGrLevelObserver * getView() const { return view; }
+
+    /**
+     * Passes all the requests in the buffer to the view and empties it.
+     */
+    void flush();
+
+    void setGoldEnemiesRule (bool showIt) override;
+    void setGridSize    (const int width, const int height) override;
+    void paintCell      (const int i, const int j, const char type) override;
+    void makeSprite     (const int spriteId, const char type,
+                         int i, int j) override;
+    void startAnimation (const int spriteId, const bool repeating,
+                         const int i, const int j, const int time,
+                         const Direction dirn,
+                         const AnimationType type) override;
+    void deleteSprite   (const int spriteId) override;
+    void gotGold        (const int spriteId, const int i, const int j,
+                         const bool hasGold, const bool lost) override;
+    void showHiddenLadders (const QList<int> & ladders,
+                            const int width) override;
+    void animate        (bool missed) override;
+    void getMousePos    (int & i, int & j) override;
+    void setMousePos    (const int i, const int j) override;
+
+private:
+    enum Request {PaintCell, MakeSprite, StartAnimation, DeleteSprite,
+                  GotGold, ShowHiddenLadders};
+
+    typedef struct {
+        Request       request;
+        int           spriteId;		// Also the index of a list of ladders.
+        int           i;
+        int           j;
+        int           time;		// Also the width for hidden ladders.
+        char          type;		// Cell or sprite type.
+        bool          flag1;		// repeating or hasGold.
+        bool          flag2;		// lost.
+        Direction     dirn;
+        AnimationType animation;
+    } Command;
+
+    KGrLevelObserver *  view;
+    QList<Command>      commands;
+    QList<QList<int> >  ladderLists;	// Lists of hidden ladders to show.
+
+    void append (const Request request, const int spriteId,
+                 const int i, const int j);
+};
+
+#endif // KGRRENDERBUFFER_H
@@ -116,37 +116,38 @@ Direction KGrTraditionalRules::findBestWay (const int eI, const int eJ,
 
 Direction KGrTraditionalRules::searchUp (int ew, int eh, int hh)
 {
-    int i, ilen, ipos, j, jlen, jpos, deltah, rungs;
+    int i, ilen, ipos, j, jlen, jpos, deltah, rungs, reach;
+    const KGrNavField & nav = grid->navField();
 
     deltah = eh - hh;			// Get distance up to hero's level.
 
+    // No ladder can be better than one that reaches the hero's level, so the
+    // searches can stop when they find one.  Only the cells with ladders need
+    // to be looked at: the others have zero length.
+    const int best = std::max (deltah, 1);
+
     // Search for the best ladder right here or on the left.
-    i = ew; ilen = 0; ipos = -1;
-    while (i >= 1) {
+    reach = reachLeft (ew, eh);		// How far can we look to the left?
+    ilen = 0; ipos = -1;
+    for (i = nav.ladderLeft (ew, eh); (i >= reach) && (ilen < best);
+         i = nav.ladderLeft (i - 1, eh)) {
         rungs = distanceUp (i, eh, deltah);
         if (rungs > ilen) {
             ilen = rungs;		// This the best yet.
             ipos = i;
         }
-        if (searchOK (-1, i, eh))
-            i--;			// Look further to the left.
-        else
-            i = -1;			// Cannot go any further to the left.
     }
 
     // Search for the best ladder on the right.
-    j = ew; jlen = 0; jpos = -1;
-    while (j < FIELDWIDTH) {
-        if (searchOK (+1, j, eh)) {
-            j++;			// Look further to the right.
-            rungs = distanceUp (j, eh, deltah);
-            if (rungs > jlen) {
-                jlen = rungs;		// This the best yet.
-                jpos = j;
-            }
+    reach = reachRight (ew, eh);	// How far can we look to the right?
+    jlen = 0; jpos = -1;
+    for (j = nav.ladderRight (ew + 1, eh); (j <= reach) && (jlen < best);
+         j = nav.ladderRight (j + 1, eh)) {
+        rungs = distanceUp (j, eh, deltah);
+        if (rungs > jlen) {
+            jlen = rungs;		// This the best yet.
+            jpos = j;
         }
-        else
-            j = FIELDWIDTH+1;		// Cannot go any further to the right.
     }
 
     if ((ilen == 0) && (jlen == 0))	// No ladder found.
@@ -180,47 +181,51 @@ Direction KGrTraditionalRules::searchUp (int ew, int eh, int hh)
 
 Direction KGrTraditionalRules::searchDown (int ew, int eh, int hh)
 {
-    int i, ilen, ipos, j, jlen, jpos, deltah, rungs, path;
+    int i, ilen, ipos, j, jlen, jpos, deltah, rungs, path, reach;
+    const KGrNavField & nav = grid->navField();
 
     deltah = hh - eh;			// Get distance down to hero's level.
 
+    // No way down can be better than one with an exit at the hero's level or,
+    // as a last resort, one that goes down one cell, so the searches can stop
+    // when they find one.  Only the columns with a way down need to be looked
+    // at: the others have zero length.
+    const int best = std::max (deltah, 1);
+
     // Search for the best way down, right here or on the left.
     ilen = 0; ipos = -1;
-    i = (willNotFall (ew, eh)) ? ew : -1;
     rungs = distanceDown (ew, eh, deltah);
     if (rungs > 0) {
         ilen = rungs; ipos = ew;
     }
 
-    while (i >= 1) {
-        rungs = distanceDown (i - 1, eh, deltah);
-        if (((rungs > 0) && (ilen == 0)) ||
-            ((deltah > 0) && (rungs > ilen)) ||
-            ((deltah <= 0) && (rungs < ilen) && (rungs != 0))) {
-            ilen = rungs;		// This the best way yet.
-            ipos = i - 1;
+    if (willNotFall (ew, eh)) {
+        // Look at each column we can reach, plus the column beyond the last.
+        reach = std::max (reachLeft (ew, eh) - 1, 1);
+        for (i = nav.dropLeft (ew - 1, eh); (i >= reach) && (ilen != best);
+             i = nav.dropLeft (i - 1, eh)) {
+            rungs = distanceDown (i, eh, deltah);
+            if (((rungs > 0) && (ilen == 0)) ||
+                ((deltah > 0) && (rungs > ilen)) ||
+                ((deltah <= 0) && (rungs < ilen) && (rungs != 0))) {
+                ilen = rungs;		// This the best way yet.
+                ipos = i;
+            }
         }
-        if (searchOK (-1, i, eh))
-            i--;			// Look further to the left.
-        else
-            i = -1;			// Cannot go any further to the left.
     }
 
     // Search for the best way down, on the right.
-    j = ew; jlen = 0; jpos = -1;
-    while (j < FIELDWIDTH) {
-        rungs = distanceDown (j + 1, eh, deltah);
+    reach = std::min (reachRight (ew, eh) + 1, grid->levelWidth());
+    jlen = 0; jpos = -1;
+    for (j = nav.dropRight (ew + 1, eh); (j <= reach) && (jlen != best);
+         j = nav.dropRight (j + 1, eh)) {
+        rungs = distanceDown (j, eh, deltah);
         if (((rungs > 0) && (jlen == 0)) ||
             ((deltah > 0) && (rungs > jlen)) ||
             ((deltah <= 0) && (rungs < jlen) && (rungs != 0))) {
             jlen = rungs;		// This the best way yet.
-            jpos = j + 1;
-        }
-        if (searchOK (+1, j, eh)) {
-            j++;			// Look further to the right.
+            jpos = j;
         }
-        else
-            j = FIELDWIDTH+1;		// Cannot go any further to the right.
     }
 
     if ((ilen == 0) && (jlen == 0))	// Found no way down.
@@ -268,11 +273,18 @@ Direction KGrTraditionalRules::searchDown (int ew, int eh, int hh)
 
 Direction KGrTraditionalRules::getHero (int eI, int eJ, int hI)
 {
-    int i, inc, returnValue;
+    int i, inc, returnValue, steps;
+    const KGrNavField & nav = grid->navField();
 
     inc = (eI > hI) ? -1 : +1;
     i = eI;
     while (i != hI) {
+        // Skip the cells where the enemy is sure to be able to keep running.
+        steps = (inc < 0) ? nav.walkLeft (i, eJ) : nav.walkRight (i, eJ);
+        i = i + inc * std::min (steps, std::abs (hI - i));
+        if (i == hI)
+            break;
+
         returnValue = canWalkLR (inc, i, eJ);
         if (returnValue > 0)
             i = i + inc;		// Can run further towards the hero.
@@ -289,16 +301,9 @@ Direction KGrTraditionalRules::getHero (int eI, int eJ, int hI)
 
 int KGrTraditionalRules::distanceUp (int x, int y, int deltah)
 {
-    int rungs = 0;
-
     // If there is a ladder at (x,y), return its length, else return zero.
-    while (grid->cellType (x, y - rungs) == LADDER) {
-        rungs++;
-        if (rungs >= deltah) {		// To hero's level is enough.
-            break;
-        }
-    }
-    return rungs;
+    // Its length up to the hero's level (or one rung) is enough.
+    return std::min (grid->navField().ladderUp (x, y), std::max (deltah, 1));
 }
 
 int KGrTraditionalRules::distanceDown (int x, int y, int deltah)
@@ -366,6 +371,32 @@ int KGrTraditionalRules::distanceDown (int x, int y, int deltah)
         return rungs;			// We can go down all the way.
 }
 
+int KGrTraditionalRules::reachLeft (int x, int y)
+{
+    // Find how far left searchOK() lets a search go from (x,y).  Jump over the
+    // cells where it must succeed, then check the cell where it might not:
+    // an enemy below that cell could still be a floor to walk on.
+    const KGrNavField & nav = grid->navField();
+    x = x - nav.searchLeft (x, y);
+    while (searchOK (-1, x, y)) {
+        x = x - 1;
+        x = x - nav.searchLeft (x, y);
+    }
+    return x;
+}
+
+int KGrTraditionalRules::reachRight (int x, int y)
+{
+    // Find how far right searchOK() lets a search go from (x,y).
+    const KGrNavField & nav = grid->navField();
+    x = x + nav.searchRight (x, y);
+    while (searchOK (+1, x, y)) {
+        x = x + 1;
+        x = x + nav.searchRight (x, y);
+    }
+    return x;
+}
+
 bool KGrTraditionalRules::searchOK (int direction, int x, int y)
 {
     // Check whether it is OK to search left or right.
@@ -506,6 +537,7 @@ Direction KGrKGoldrunnerRules::findWayUp (const int eI, const int eJ)
 {
     int i, k;
     i = k = eI;
+    const int levelWidth = grid->levelWidth();
 
     // Must be able to stand AND move through cells when looking left or right.
     Flags leftOK  = (dFlag [LEFT] | dFlag [STAND]);
@@ -515,7 +547,7 @@ Direction KGrKGoldrunnerRules::findWayUp (const int eI, const int eJ)
         return UP;			// Go up from current position.
     }
     else {
-        while ((i >= 0) || (k <= FIELDWIDTH)) {
+        while ((i >= 0) || (k <= levelWidth)) {
             if (i >= 0) {
                 if (grid->enemyMoves (i, eJ) & dFlag [UP]) {
                     return LEFT;	// Go left, then up later.
@@ -524,12 +556,12 @@ Direction KGrKGoldrunnerRules::findWayUp (const int eI, const int eJ)
                     i = -1;
                 }
             }
-            if (k <= FIELDWIDTH) {
+            if (k <= levelWidth) {
                 if (grid->enemyMoves (k, eJ) & dFlag [UP]) {
                     return RIGHT;	// Go right, then up later.
                 }
                 else if ((grid->enemyMoves (k++, eJ) & rightOK) != rightOK) {
-                    k = FIELDWIDTH + 1;
+                    k = levelWidth + 1;
                 }
             }
         }
@@ -541,13 +573,14 @@ Direction KGrKGoldrunnerRules::findWayDown (const int eI, const int eJ)
 {
     int i, k;
     i = k = eI;
+    const int levelWidth = grid->levelWidth();
 
     // In this search, no need to test for STAND.  Fall and ladder are both OK.
     if (grid->enemyMoves (eI, eJ) & dFlag [DOWN]) {
         return DOWN;			// Go down from current position.
     }
     else {
-        while ((i >= 0) || (k <= FIELDWIDTH)) {
+        while ((i >= 0) || (k <= levelWidth)) {
             if (i >= 0) {
                 if (grid->enemyMoves (i, eJ) & dFlag [DOWN]) {
                     return LEFT;	// Go left, then down later.
@@ -556,12 +589,12 @@ Direction KGrKGoldrunnerRules::findWayDown (const int eI, const int eJ)
                     i = -1;
                 }
             }
-            if (k <= FIELDWIDTH) {
+            if (k <= levelWidth) {
                 if (grid->enemyMoves (k, eJ) & dFlag [DOWN]) {
                     return RIGHT;	// Go right, then down later.
                 }
                 else if (! (grid->enemyMoves (k++, eJ) & dFlag [RIGHT])) {
-                    k = FIELDWIDTH + 1;
+                    k = levelWidth + 1;
                 }
             }
         }
@@ -573,6 +606,7 @@ Direction KGrKGoldrunnerRules::findWayLeft (const int eI, const int eJ)
 {
     int i, k;
     i = k = eJ;
+    const int levelHeight = grid->levelHeight();
 
     // Must be able to stand and move through cells when checking move-left.
     Flags leftOK = (dFlag [LEFT] | dFlag [STAND]);
@@ -581,7 +615,7 @@ Direction KGrKGoldrunnerRules::findWayLeft (const int eI, const int eJ)
         return LEFT;			// Go left from current position.
     }
     else {
-        while ((i >= 0) || (k <= FIELDHEIGHT)) {
+        while ((i >= 0) || (k <= levelHeight)) {
             if (i >= 0) {
                 if ((grid->enemyMoves (eI, i) & leftOK) == leftOK) {
                     return UP;		// Go up, then left later.
@@ -590,12 +624,12 @@ Direction KGrKGoldrunnerRules::findWayLeft (const int eI, const int eJ)
                     i = -1;
                 }
             }
-            if (k <= FIELDHEIGHT) {
+            if (k <= levelHeight) {
                 if ((grid->enemyMoves (eI, k) & leftOK) == leftOK) {
                     return DOWN;	// Go down, then left later.
                 }
                 else if (! (grid->enemyMoves (eI, k++) & dFlag [DOWN])) {
-                    k = FIELDHEIGHT + 1;
+                    k = levelHeight + 1;
                 }
             }
         }
@@ -607,6 +641,7 @@ Direction KGrKGoldrunnerRules::findWayRight (const int eI, const int eJ)
 {
     int i, k;
     i = k = eJ;
+    const int levelHeight = grid->levelHeight();
 
     // Must be able to stand and move through cells when checking move-right.
     Flags rightOK = (dFlag [RIGHT] | dFlag [STAND]);
@@ -615,7 +650,7 @@ Direction KGrKGoldrunnerRules::findWayRight (const int eI, const int eJ)
         return RIGHT;			// Go right from current position.
     }
     else {
-        while ((i >= 0) || (k <= FIELDHEIGHT)) {
+        while ((i >= 0) || (k <= levelHeight)) {
             if (i >= 0) {
                 if ((grid->enemyMoves (eI, i) & rightOK) == rightOK) {
                     return UP;		// Go up, then right later.
@@ -624,12 +659,12 @@ Direction KGrKGoldrunnerRules::findWayRight (const int eI, const int eJ)
                     i = -1;
                 }
             }
-            if (k <= FIELDHEIGHT) {
+            if (k <= levelHeight) {
                 if ((grid->enemyMoves (eI, k) & rightOK) == rightOK) {
                     return DOWN;	// Go down, then right later.
                 }
                 else if (! (grid->enemyMoves (eI, k++) & dFlag [DOWN])) {
-                    k = FIELDHEIGHT + 1;
+                    k = levelHeight + 1;
                 }
             }
         }
@@ -640,7 +675,11 @@ Direction KGrKGoldrunnerRules::findWayRight (const int eI, const int eJ)
 
 KGrScavengerRules::KGrScavengerRules (QObject * parent)
     :
-    KGrRuleBook (parent)
+    KGrRuleBook (parent),
+    fieldGrid   (nullptr),
+    heroCell    (-1),
+    heroChanges (-1),
+    goldChanges (-1)
 {
     mRules               = ScavengerRules;
 
@@ -668,7 +707,76 @@ Direction KGrScavengerRules::findBestWay   (const int eI, const int eJ,
 {
     dbk2 << eI << eJ << hI << hJ;
     grid = pGrid;
-    return RIGHT;
+
+    if (grid->cellType (eI, eJ) == USEDHOLE) {	// Could not get out of hole
+        return UP;				// (e.g. brick above is closed):
+    }						// but keep trying.
+
+    Flags moves = grid->enemyMoves (eI, eJ);
+    bool canStand = (moves & dFlag [STAND]) ||
+                    (grid->enemyOccupied (eI, eJ + 1) > 0);
+    if (! canStand) {
+        return DOWN;
+    }
+
+    // Scavenger search strategy: take the shortest way to the hero, but of
+    // equally short ways take the one that passes nearest to some gold.  If
+    // the hero cannot be reached, go for the gold.  The distance fields are
+    // shared by all the enemies, so each decision looks at only four cells.
+    updateFields (hI, hJ);
+    Direction best     = STAND;
+    int       bestHero = heroField.distance (eI, eJ);
+    int       bestGold = goldField.distance (eI, eJ);
+    const Direction ways [4] = {LEFT, RIGHT, UP, DOWN};
+    for (const Direction dirn : ways) {
+        if (! (moves & dFlag [dirn])) {
+            continue;
+        }
+        int i = eI + movement [dirn][X];
+        int j = eJ + movement [dirn][Y];
+        int toHero = heroField.distance (i, j);
+        int toGold = goldField.distance (i, j);
+        if ((toHero < bestHero) ||
+            ((toHero == bestHero) && (toGold < bestGold))) {
+            best     = dirn;
+            bestHero = toHero;
+            bestGold = toGold;
+        }
+    }
+    return best;
+}
+
+void KGrScavengerRules::updateFields (const int hI, const int hJ)
+{
+    // Build the fields again only if the grid has changed since they were
+    // built (e.g. a brick has been dug or gold has been picked up) or, for
+    // the hero's field, the hero has gone into another cell.  Each build is a
+    // full search of the grid: there is no incremental update.
+    int  width   = grid->gridWidth();
+    int  changes = grid->changeCount();
+    int  hero    = hI + hJ * width;
+    bool newGrid = (grid != fieldGrid);
+    fieldGrid    = grid;
+
+    if (newGrid || (changes != heroChanges) || (hero != heroCell)) {
+        heroField.build (grid, QList<int> {hero});
+        heroCell    = hero;
+        heroChanges = changes;
+    }
+
+    if (newGrid || (changes != goldChanges)) {
+        QList<int> gold;
+        int height = grid->levelHeight() + 2 * ConcreteWall;
+        for (int j = 1; j < height - 1; j++) {
+            for (int i = 1; i < width - 1; i++) {
+                if (grid->cellType (i, j) == NUGGET) {
+                    gold.append (i + j * width);
+                }
+            }
+        }
+        goldField.build (grid, gold);
+        goldChanges = changes;
+    }
 }
 
 #include "moc_kgrrulebook.cpp"
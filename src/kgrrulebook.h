@@ -7,6 +7,7 @@
 #ifndef KGRRULEBOOK_H
 #define KGRRULEBOOK_H
 
+#include "kgrdistancefield.h"
 #include "kgrglobals.h"
 
 #include <QObject>
@@ -96,6 +97,8 @@ private:
 
     int       distanceUp   (int x,  int y,  int deltah);
     int       distanceDown (int x,  int y,  int deltah);
+    int       reachLeft    (int x,  int y);
+    int       reachRight   (int x,  int y);
     bool      searchOK     (int direction,  int x, int y);
     int       canWalkLR    (int direction,  int x, int y);
     bool      willNotFall  (int x,  int y);
@@ -122,6 +125,18 @@ private:
 };
 
 
+/**
+ * The Scavenger rules find the way for an enemy with two distance fields (see
+ * KGrDistanceField): moves to the hero and moves to the nearest gold.  Once
+ * the fields are built, each decision looks at only four cells.  But each
+ * field is built again in full, in time proportional to the number of cells,
+ * whenever the grid's change-count moves: at every dig, refilling of a hole
+ * and pickup or drop of gold.  The hero's field is also built again whenever
+ * the hero goes into another cell, and the list of gold for the gold field
+ * is found by scanning the whole grid.  So in normal play the fields are
+ * built again many times a second and the cost of a decision is only O(1)
+ * when it is shared with the other enemies' decisions between rebuilds.
+ */
 class KGrScavengerRules : public KGrRuleBook
 {
     Q_OBJECT
@@ -133,6 +148,16 @@ public:
                            const int hI, const int hJ,
                            KGrLevelGrid * pGrid,
                            bool leftRightSearch = true) override;
+
+private:
+    void updateFields     (const int hI, const int hJ);
+
+    KGrDistanceField heroField;		// Moves to the hero's cell.
+    KGrDistanceField goldField;		// Moves to the nearest gold.
+    KGrLevelGrid *   fieldGrid;		// The grid the fields were built for.
+    int              heroCell;		// The hero's cell, as in heroField.
+    int              heroChanges;	// Grid change-count, as in heroField.
+    int              goldChanges;	// Grid change-count, as in goldField.
 };
 
 #endif // KGRRULEBOOK_H
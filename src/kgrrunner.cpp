@@ -8,6 +8,7 @@
 #include "kgrlevelgrid.h"
 #include "kgrrulebook.h"
 #include "kgrlevelplayer.h"
+#include "kgrlevelobserver.h"
 #include "kgoldrunner_debug.h"
 #include "kgrdebug.h"
 
@@ -17,6 +18,8 @@ KGrRunner::KGrRunner (KGrLevelPlayer * pLevelPlayer, KGrLevelGrid * pGrid,
     :
     QObject     (pLevelPlayer),	// Destroy runner when level is destroyed.
     levelPlayer (pLevelPlayer),
+    store       (pLevelPlayer->runnerStore()),
+    observer    (pLevelPlayer->levelObserver()),
     grid        (pGrid),
     rules       (pRules),
     spriteId    (pSpriteId),
@@ -27,21 +30,21 @@ KGrRunner::KGrRunner (KGrLevelPlayer * pLevelPlayer, KGrLevelGrid * pGrid,
     pointCtr    (0),
     falling     (false),
 
-    currDirection (STAND),
     currAnimation (FALL_L),
 
-    // The start delay is zero for the hero and 50 msec for the enemies.  This
-    // gives the hero about one grid-point advantage.  Without this lead, some
-    // levels become impossible, notably Challenge, 4, "Quick Off The Mark" and
-    // Curse of the Mummy, 20, "The Parting of the Red Sea".
-    timeLeft  (TickTime + startDelay),
-
     leftRightSearch (true)
 {
     getRules();
 
-    gridX    = i * pointsPerCell;
-    gridY    = j * pointsPerCell;
+    store->add (spriteId);
+    setGridXY (i * pointsPerCell, j * pointsPerCell);
+    setCurrDirection (STAND);
+
+    // The start delay is zero for the hero and 50 msec for the enemies.  This
+    // gives the hero about one grid-point advantage.  Without this lead, some
+    // levels become impossible, notably Challenge, 4, "Quick Off The Mark" and
+    // Curse of the Mummy, 20, "The Parting of the Red Sea".
+    timeLeft() = TickTime + startDelay;
 
     // As soon as the initial timeLeft has expired (i.e. at the first tick in
     // the hero's case and after a short delay in the enemies' case), the
@@ -66,42 +69,81 @@ void KGrRunner::getRules()
     //}
 }
 
+void KGrRunner::saveState (State & s)
+{
+    s.gridI           = gridI;
+    s.gridJ           = gridJ;
+    s.deltaX          = deltaX;
+    s.deltaY          = deltaY;
+    s.pointCtr        = pointCtr;
+    s.interval        = interval;
+    s.falling         = falling;
+    s.leftRightSearch = leftRightSearch;
+    s.onEnemy         = onEnemy;
+    s.currAnimation   = currAnimation;
+    s.nuggets         = 0;
+    s.prevInCell      = -1;
+}
+
+void KGrRunner::restoreState (const State & s)
+{
+    gridI           = s.gridI;
+    gridJ           = s.gridJ;
+    deltaX          = s.deltaX;
+    deltaY          = s.deltaY;
+    pointCtr        = s.pointCtr;
+    interval        = s.interval;
+    falling         = s.falling;
+    leftRightSearch = s.leftRightSearch;
+    onEnemy         = s.onEnemy;
+    currAnimation   = s.currAnimation;
+}
+
+void KGrRunner::redraw (const int scaledTime)
+{
+    // The view can only start an animation at a cell, so a runner that is
+    // part-way across a cell is shown from the cell's start until it reaches
+    // the next cell, where it gets a new animation anyway.
+    observer->startAnimation (spriteId, true, gridI, gridJ,
+                         (interval * pointsPerCell * TickTime) / scaledTime,
+                         currDirection(), currAnimation);
+}
+
 Situation KGrRunner::situation (const int scaledTime)
 {
-    timeLeft -= scaledTime;
-    if (timeLeft >= scaledTime) {
+    timeLeft() -= scaledTime;
+    if (timeLeft() >= scaledTime) {
         dbe3 "%d sprite %02d scaled %02d timeLeft %03d - Not Time Yet\n",
-             pointCtr, spriteId, scaledTime, timeLeft);
+             pointCtr, spriteId, scaledTime, timeLeft());
         return NotTimeYet;
     }
 
     if (grid->cellType  (gridI, gridJ) == BRICK) {
         dbe2 "%d sprite %02d scaled %02d timeLeft %03d - Caught in brick\n",
-             pointCtr, spriteId, scaledTime, timeLeft);
+             pointCtr, spriteId, scaledTime, timeLeft());
         return CaughtInBrick;
     }
 
-    gridX += deltaX;
-    gridY += deltaY;
+    setGridXY (gridX() + deltaX, gridY() + deltaY);
     pointCtr++;
 
     if (pointCtr < pointsPerCell) {
-        timeLeft += interval;
+        timeLeft() += interval;
         dbe2 "%d sprite %02d scaled %02d timeLeft %03d - Mid Cell\n",
-             pointCtr, spriteId, scaledTime, timeLeft);
+             pointCtr, spriteId, scaledTime, timeLeft());
         return MidCell;
     }
 
     dbe2 "%d sprite %02d scaled %02d timeLeft %03d - END Cell\n",
-         pointCtr, spriteId, scaledTime, timeLeft);
+         pointCtr, spriteId, scaledTime, timeLeft());
     return EndCell;
 }
 
 char KGrRunner::nextCell()
 {
     pointCtr = 0;
-    gridI    = gridX / pointsPerCell;
-    gridJ    = gridY / pointsPerCell;
+    gridI    = gridX() / pointsPerCell;
+    gridJ    = gridY() / pointsPerCell;
     return     grid->cellType  (gridI, gridJ);
 }
 
@@ -137,9 +179,9 @@ bool KGrRunner::setNextMovement (const char spriteType, const char cellType,
     interval = runTime;
 
     // if (spriteType == HERO) {
-        // qCDebug(KGOLDRUNNER_LOG) << "Calling standOnEnemy() for" << gridX << gridY;
+        // qCDebug(KGOLDRUNNER_LOG) << "Calling standOnEnemy() for" << gridX() << gridY();
     // }
-    onEnemy  = levelPlayer->standOnEnemy (spriteId, gridX, gridY);
+    onEnemy  = levelPlayer->standOnEnemy (spriteId, gridX(), gridY());
     bool canStand = (OK & dFlag [STAND]) || (OK == 0) || onEnemy;
     if ((dir == DOWN) && (cellType == BAR)) {
         canStand = false;
@@ -151,7 +193,7 @@ bool KGrRunner::setNextMovement (const char spriteType, const char cellType,
     //        the captive time is now OK.  Total t down by ~100 in 4400.
     if ((spriteType == ENEMY) && (cellType == USEDHOLE)) {
         // The enemy is in a hole.
-        if (currDirection == DOWN) {
+        if (currDirection() == DOWN) {
             // The enemy is at the bottom of the hole: start the captive-timer.
             dir = STAND;
             anim = currAnimation;
@@ -174,7 +216,7 @@ bool KGrRunner::setNextMovement (const char spriteType, const char cellType,
         interval = onEnemy ? enemyFallTime : fallTime;
         dir  = DOWN;
         anim = (falling) ? currAnimation :
-                           ((currDirection == RIGHT) ? FALL_R : FALL_L);
+                           ((currDirection() == RIGHT) ? FALL_R : FALL_L);
     }
     else if (cannotMoveAsRequired) {
         // Sprite cannot move, but the animation shows the desired direction.
@@ -224,8 +266,8 @@ HeroStatus KGrHero::run (const int scaledTime)
 
     // Check if we have fallen onto an enemy.  If so, continue at enemy-speed.
     if (falling && (interval != enemyFallTime)) {
-        // qCDebug(KGOLDRUNNER_LOG) << "Calling standOnEnemy() for" << gridX << gridY;
-	onEnemy = levelPlayer->standOnEnemy (spriteId, gridX, gridY);
+        // qCDebug(KGOLDRUNNER_LOG) << "Calling standOnEnemy() for" << gridX() << gridY();
+	onEnemy = levelPlayer->standOnEnemy (spriteId, gridX(), gridY());
         if (onEnemy != nullptr) {
             interval = enemyFallTime;
             // If MidCell, hero-speed animation overshoots, but looks OK.
@@ -233,13 +275,13 @@ HeroStatus KGrHero::run (const int scaledTime)
     }
 
     // We need to check collision with enemies on every grid-point.
-    if (levelPlayer->heroCaught (gridX, gridY)) {
+    if (levelPlayer->heroCaught (gridX(), gridY())) {
         return DEAD;
     }
 
     // Emit StepSound once per cell or ClimbSound twice per cell.
     if (((s == EndCell) || (pointCtr == (pointsPerCell/2))) &&
-        (currDirection != STAND) && (! falling)) {
+        (currDirection() != STAND) && (! falling)) {
         int step = ((currAnimation == RUN_R) || (currAnimation == RUN_L)) ?
                     StepSound : ClimbSound;
         if ((s == EndCell) || (step == ClimbSound)) {
@@ -273,13 +315,13 @@ HeroStatus KGrHero::run (const int scaledTime)
         Q_EMIT soundSignal (FallSound, newFallingState);	// Start/stop falling.
         falling = newFallingState;
     }
-    timeLeft += interval;
+    timeLeft() += interval;
     dbe2 "%d sprite %02d [%02d,%02d] timeLeft %03d currDir %d nextDir %d "
             "currAnim %d nextAnim %d\n",
-      pointCtr, spriteId, gridI, gridJ, timeLeft, currDirection, nextDirection,
+      pointCtr, spriteId, gridI, gridJ, timeLeft(), currDirection(), nextDirection,
       currAnimation, nextAnimation);
 
-    if ((nextDirection == currDirection) && (nextAnimation == currAnimation)) {
+    if ((nextDirection == currDirection()) && (nextAnimation == currAnimation)) {
         if (nextDirection == STAND) {
             return NORMAL;
         }
@@ -289,11 +331,11 @@ HeroStatus KGrHero::run (const int scaledTime)
     deltaY = movement [nextDirection][Y];
 
     // Start the running animation (repeating).
-    Q_EMIT startAnimation (spriteId, true, gridI, gridJ,
+    observer->startAnimation (spriteId, true, gridI, gridJ,
                          (interval * pointsPerCell * TickTime) / scaledTime,
                          nextDirection, nextAnimation);
     currAnimation = nextAnimation;
-    currDirection = nextDirection;
+    setCurrDirection (nextDirection);
     return NORMAL;
 }
 
@@ -308,11 +350,11 @@ bool KGrHero::dig (const Direction diggingDirection, int & i, int & j)
     // If currDirection is UP, DOWN or STAND, dig next cell left or right.
     int relativeI = (diggingDirection == DIG_LEFT) ? -1 : +1;
 
-    if ((currDirection == LEFT) && (moves & dFlag [LEFT])) {
+    if ((currDirection() == LEFT) && (moves & dFlag [LEFT])) {
         // Running LEFT, so stop at -1: dig LEFT at -2 or dig RIGHT right here.
         relativeI = (diggingDirection == DIG_LEFT) ? -2 : 0;
     }
-    else if ((currDirection == RIGHT) && (moves & dFlag [RIGHT])) {
+    else if ((currDirection() == RIGHT) && (moves & dFlag [RIGHT])) {
         // Running RIGHT, so stop at +1: dig LEFT right here or dig RIGHT at -2.
         relativeI = (diggingDirection == DIG_LEFT) ? 0 : +2;
     }
@@ -336,22 +378,22 @@ bool KGrHero::dig (const Direction diggingDirection, int & i, int & j)
 	    // Work out where the hero WILL be standing when he digs. In the
 	    // second case, he will dig the brick that is now right under him.
             int nextGridI = (relativeI != 0) ? (gridI + relativeI/2) :
-                        ((currDirection == LEFT) ? (gridI - 1) : (gridI + 1));
+                        ((currDirection() == LEFT) ? (gridI - 1) : (gridI + 1));
             Flags OK = grid->heroMoves (nextGridI, gridJ);
             bool canStand = (OK & dFlag [STAND]) || (OK == 0);
             bool enemyUnder = (onEnemy != nullptr);
             // Must be on solid ground or on an enemy (standing or riding down).
             if ((! canStand) && (nextGridI != gridI)) {
 		// If cannot move to next cell and stand, is an enemy under it?
-                // qCDebug(KGOLDRUNNER_LOG) << "Calling standOnEnemy() at gridX" << gridX
-                         // << "for" << (nextGridI * pointsPerCell) << gridY;
+                // qCDebug(KGOLDRUNNER_LOG) << "Calling standOnEnemy() at gridX" << gridX()
+                         // << "for" << (nextGridI * pointsPerCell) << gridY();
                 enemyUnder = (levelPlayer->standOnEnemy (spriteId,
-                                        nextGridI * pointsPerCell, gridY) != nullptr);
+                                        nextGridI * pointsPerCell, gridY()) != nullptr);
             }
             if ((! canStand) && (! enemyUnder)) {
                 qCDebug(KGOLDRUNNER_LOG) << "INVALID DIG: hero at" << gridI << gridJ
                          << "nextGridI" << nextGridI << "relI" << relativeI
-                         << "dirn" << currDirection << "brick at" << i << j
+                         << "dirn" << currDirection() << "brick at" << i << j
                          << "heroMoves" << ((int) OK) << "canStand" << canStand
                          << "enemyUnder" << enemyUnder;
                 Q_EMIT invalidDig();	// Issue warning re dig while falling.
@@ -370,9 +412,21 @@ void KGrHero::showState()
 {
     fprintf (stderr, "(%02d,%02d) %02d Hero ", gridI, gridJ, spriteId);
     fprintf (stderr, " gold %02d dir %d ctr %d",
-                  nuggets, currDirection, pointCtr);
+                  nuggets, currDirection(), pointCtr);
     fprintf (stderr, " X %3d Y %3d anim %d dt %03d\n",
-                 gridX, gridY, currAnimation, interval);
+                 gridX(), gridY(), currAnimation, interval);
+}
+
+void KGrHero::saveState (State & s)
+{
+    KGrRunner::saveState (s);
+    s.nuggets = nuggets;
+}
+
+void KGrHero::restoreState (const State & s)
+{
+    KGrRunner::restoreState (s);
+    nuggets = s.nuggets;
 }
 
 
@@ -418,7 +472,7 @@ void KGrEnemy::run (const int scaledTime)
         // Go to next cell, with s = CaughtInBrick, thus forcing re-animation.
     }
 
-    else if ((pointCtr == 1) && (currDirection == DOWN) &&
+    else if ((pointCtr == 1) && (currDirection() == DOWN) &&
         (grid->cellType (gridI, gridJ + 1) == HOLE)) {
         // Enemy is starting to fall into a hole.
         dbe1 "T %05lld id %02d Mark hole [%02d,%02d] as used\n",
@@ -442,7 +496,7 @@ void KGrEnemy::run (const int scaledTime)
     char cellType = nextCell();
 
     // Try to pick up or drop gold in the new cell.
-    if (currDirection != STAND) {
+    if (currDirection() != STAND) {
         checkForGold();
     }
 
@@ -456,7 +510,7 @@ void KGrEnemy::run (const int scaledTime)
     // If the enemy just left a hole, change it to empty.  Must execute this
     // code AFTER finding the next direction and valid moves, otherwise the
     // enemy will just fall back into the hole again.
-    if ((currDirection == UP) &&
+    if ((currDirection() == UP) &&
         (grid->cellType  (gridI, gridJ + 1) == USEDHOLE)) {
         dbk3 << spriteId << "Hole emptied at" << gridI << (gridJ + 1);
         // Empty the hole, provided it had not somehow caught two enemies.
@@ -467,8 +521,8 @@ void KGrEnemy::run (const int scaledTime)
 
     dbe2 "%d sprite %02d [%02d,%02d] timeLeft %03d currDir %d nextDir %d "
             "currAnim %d nextAnim %d\n",
-      pointCtr, spriteId, gridI, gridJ, timeLeft,
-      currDirection, nextDirection, currAnimation, nextAnimation);
+      pointCtr, spriteId, gridI, gridJ, timeLeft(),
+      currDirection(), nextDirection, currAnimation, nextAnimation);
 
     if (fallingState != falling) {
         falling = fallingState;
@@ -491,7 +545,7 @@ void KGrEnemy::run (const int scaledTime)
         pointCtr = pointsPerCell - 1;
     }
 
-    timeLeft += interval;
+    timeLeft() += interval;
     deltaX = movement [nextDirection][X];
     deltaY = movement [nextDirection][Y];
 
@@ -514,7 +568,7 @@ void KGrEnemy::run (const int scaledTime)
         reserveCell (nextI, nextJ);
     }
 
-    if ((nextDirection == currDirection) && (nextAnimation == currAnimation)) {
+    if ((nextDirection == currDirection()) && (nextAnimation == currAnimation)) {
         if ((nextDirection == STAND) && (s != CaughtInBrick)) {
             // In the CaughtInBrick situation, enemy sprites must not be shown
             // standing in the bricks where they died: we must re-animate them.
@@ -523,11 +577,11 @@ void KGrEnemy::run (const int scaledTime)
     }
 
     // Start the running animation (repeating).
-    Q_EMIT startAnimation (spriteId, true, gridI, gridJ,
+    observer->startAnimation (spriteId, true, gridI, gridJ,
                          (interval * pointsPerCell * TickTime) / scaledTime,
                          nextDirection, nextAnimation);
     currAnimation = nextAnimation;
-    currDirection = nextDirection;
+    setCurrDirection (nextDirection);
 }
 
 void KGrEnemy::dropGold()
@@ -600,16 +654,15 @@ void KGrEnemy::dieAndReappear()
     // There is no time-delay and no special animation here, though there was
     // in the Apple II game and there is in Scavenger.  KGoldrunner has never
     // had a time-delay here, which makes KGoldrunner more difficult sometimes.
-    gridX         = gridI * pointsPerCell;
-    gridY         = gridJ * pointsPerCell;
-    deltaX        = 0;
-    deltaY        = 0;
-    pointCtr      = pointsPerCell;
-    falling       = false;
-    interval      = runTime;
-    timeLeft      = TickTime;
-    currDirection = STAND;
-    currAnimation = FALL_L;
+    setGridXY (gridI * pointsPerCell, gridJ * pointsPerCell);
+    deltaX          = 0;
+    deltaY          = 0;
+    pointCtr        = pointsPerCell;
+    falling         = false;
+    interval        = runTime;
+    timeLeft()      = TickTime;
+    currAnimation   = FALL_L;
+    setCurrDirection (STAND);
 }
 
 void KGrEnemy::reserveCell (const int i, const int j)
@@ -617,6 +670,7 @@ void KGrEnemy::reserveCell (const int i, const int j)
     // Push down a previous enemy or -1 if the cell was empty.
     prevInCell = grid->enemyOccupied (i, j);
     grid->setEnemyOccupied (i, j, spriteId);
+    levelPlayer->enemyEntersCell (spriteId, i, j);
     dbe3 "%02d Entering [%02d,%02d] pushes %02d\n", spriteId, i, j, prevInCell);
 }
 
@@ -629,6 +683,7 @@ void KGrEnemy::releaseCell (const int i, const int j)
     else {
         levelPlayer->unstackEnemy (spriteId, i, j, prevInCell);
     }
+    levelPlayer->enemyLeavesCell (spriteId);
     dbe3 "%02d Leaves [%02d,%02d] to %02d\n", spriteId, i, j, prevInCell);
 }
 
@@ -636,9 +691,31 @@ void KGrEnemy::showState()
 {
     fprintf (stderr, "(%02d,%02d) %02d Enemy", gridI, gridJ, spriteId);
     fprintf (stderr, " gold %02d dir %d ctr %d",
-                  nuggets, currDirection, pointCtr);
+                  nuggets, currDirection(), pointCtr);
     fprintf (stderr, " X %3d Y %3d anim %d dt %03d prev %d\n",
-                 gridX, gridY, currAnimation, interval, prevInCell);
+                 gridX(), gridY(), currAnimation, interval, prevInCell);
+}
+
+void KGrEnemy::saveState (State & s)
+{
+    KGrRunner::saveState (s);
+    s.nuggets    = nuggets;
+    s.prevInCell = prevInCell;
+}
+
+void KGrEnemy::restoreState (const State & s)
+{
+    KGrRunner::restoreState (s);
+    nuggets    = s.nuggets;
+    prevInCell = s.prevInCell;
+}
+
+void KGrEnemy::redraw (const int scaledTime)
+{
+    KGrRunner::redraw (scaledTime);
+
+    // Show whether the enemy has gold, without painting any cell ("lost").
+    observer->gotGold (spriteId, gridI, gridJ, (nuggets > 0), true);
 }
 
 #include "moc_kgrrunner.cpp"
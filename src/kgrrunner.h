@@ -8,11 +8,13 @@
 #define KGRRUNNER_H
 
 #include "kgrglobals.h"
+#include "kgrrunnerstore.h"
 
 #include <QObject>
 #include <QElapsedTimer> // IDW
 
 class KGrLevelPlayer;
+class KGrLevelObserver;
 class KGrLevelGrid;
 class KGrRuleBook;
 class KGrEnemy;
@@ -56,43 +58,79 @@ public:
      * @return             The number of grid-points per cell.
      */
     inline int whereAreYou (int & x, int & y) {
-                            x = gridX; y = gridY; return pointsPerCell; }
+                            x = gridX(); y = gridY(); return pointsPerCell; }
+
+    /// A copy of the state of a runner, as kept in a KGrLevelPlayer snapshot.
+    /// The runner's position, time and direction are kept in the store.
+    typedef struct {
+        int           gridI;
+        int           gridJ;
+        int           deltaX;
+        int           deltaY;
+        int           pointCtr;
+        int           interval;
+        bool          falling;
+        bool          leftRightSearch;
+        KGrEnemy *    onEnemy;
+        AnimationType currAnimation;
+        int           nuggets;		// Hero: gold left.  Enemy: gold held.
+        int           prevInCell;	// Enemy only: see getPrevInCell().
+    } State;
 
-Q_SIGNALS:
     /**
-     * Requests the KGoldrunner game to add to the human player's score.
+     * Copies the state of the runner.
      *
-     * @param n            The amount to add to the score.
+     * @param s            Where to put the copy (return by reference).
      */
-    void incScore          (const int n);
+    virtual void     saveState (State & s);
+
+    /**
+     * Puts back the state of the runner, as copied by saveState().
+     *
+     * @param s            The copy of the state.
+     */
+    virtual void     restoreState (const State & s);
 
     /**
-     * Requests the view-object to display an animation of a runner at a
-     * particular cell, cancelling and superseding any current animation.
+     * Shows the runner in the view as it is now, by starting its animation
+     * from the cell where it is.  Used after restoreState() or a seek.
      *
-     * @param spriteId     The ID of the sprite (hero or enemy).
-     * @param repeating    If true, repeat the animation until the next signal.
-     * @param i            The column-number of the cell to start at.
-     * @param j            The row-number of the cell to start at.
-     * @param time         The time in which to traverse one cell.
-     * @param dirn         The direction of motion, or STAND.
-     * @param type         The type of animation (walk, climb. etc.).
+     * @param scaledTime   The scaled time of one tick.
      */
-    void startAnimation    (const int spriteId, const bool repeating,
-                            const int i, const int j, const int time,
-                            const Direction dirn, const AnimationType type);
+    virtual void     redraw (const int scaledTime);
+
+Q_SIGNALS:
+    /**
+     * Requests the KGoldrunner game to add to the human player's score.
+     *
+     * @param n            The amount to add to the score.
+     */
+    void incScore          (const int n);
 
 protected:
     KGrLevelPlayer * levelPlayer;
+    KGrRunnerStore * store;		// Holds the position, time and direction.
+    KGrLevelObserver * observer;	// Shows the animations (KGrScene).
     KGrLevelGrid *   grid;
     KGrRuleBook *    rules;
 
     int              spriteId;
 
+    // The runner's items in the store, used as if they were variables.  The
+    // position and direction are changed through the store, which keeps a
+    // hash of them up to date.
+    inline int       gridX()       const { return store->gridX.at (spriteId); }
+    inline int       gridY()       const { return store->gridY.at (spriteId); }
+    inline int &     timeLeft()          { return store->timeLeft [spriteId]; }
+    inline Direction currDirection() const {
+                         return store->direction.at (spriteId); }
+    inline void      setGridXY (const int x, const int y) {
+                         store->setPosition (spriteId, x, y); }
+    inline void      setCurrDirection (const Direction dirn) {
+                         store->setDirection (spriteId, dirn); }
+
     int              gridI;
     int              gridJ;
-    int              gridX;
-    int              gridY;
     int              deltaX;
     int              deltaY;
 
@@ -111,7 +149,6 @@ protected:
 
     bool             falling;
     KGrEnemy *       onEnemy;		// If standing or riding on an enemy.
-    Direction        currDirection;
     AnimationType    currAnimation;
 
     int              runTime;		// Time interval for hero/enemy running.
@@ -121,7 +158,6 @@ protected:
 					// stay trapped in a brick.
 
     int              interval;		// The runner's current time interval.
-    int              timeLeft;		// Time till the runner's next action.
 
     bool             leftRightSearch;	// KGoldrunner-rules enemy search-mode.
 
@@ -208,6 +244,9 @@ public:
      */
     void             showState();
 
+    void             saveState (State & s) override;
+    void             restoreState (const State & s) override;
+
 Q_SIGNALS:
     void             soundSignal (const int n, const bool onOff = true);
     void             invalidDig();	// Warning re dig while falling.
@@ -269,7 +308,7 @@ public:
      * Returns the direction in which the enemy is running: used for avoiding
      * collisions with other enemies.
      */
-    inline Direction direction() { return (currDirection); }
+    inline Direction direction() { return (currDirection()); }
 
     /**
      * Returns the ID of an enemy who already occupied the same cell (or -1).
@@ -294,6 +333,10 @@ public:
      */
     void             showState();
 
+    void             saveState (State & s) override;
+    void             restoreState (const State & s) override;
+    void             redraw (const int scaledTime) override;
+
 private:
     char             rulesType;		// Rules type and enemy search method.
 
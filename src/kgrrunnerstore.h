@@ -0,0 +1,137 @@
+/*
+    SPDX-FileCopyrightText: 2026 The KGoldrunner Developers
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#ifndef KGRRUNNERSTORE_H
+#define KGRRUNNERSTORE_H
+
+#include "kgrglobals.h"
+#include "kgrzobrist.h"
+
+#include <QList>
+
+#include <algorithm>
+
+/**
+ * The KGrRunnerStore class holds the state of the hero and enemies that
+ * KGrLevelPlayer looks at for all the runners, in every tick: their positions,
+ * times and directions.  Each item is kept in an array of its own, indexed by
+ * the runner's sprite ID (0 for the hero, 1 to n for the enemies), so that
+ * passes over all the enemies, such as collision checks and scheduling, read
+ * contiguous memory rather than following a pointer to each KGrEnemy object.
+ *
+ * The enemies' moves are not made in a batched pass over the arrays: each
+ * enemy that is due to act is still run by its own KGrEnemy::run(), in turn,
+ * because its move depends on the moves made just before it by the enemies
+ * ahead of it in the list (collisions, stacking and the index of enemies by
+ * cell).  Running them in any other way would change how levels play and
+ * break the replay of recordings.  The wheel in KGrLevelPlayer::runEnemies()
+ * already skips the enemies that are only waiting.
+ *
+ * KGrLevelPlayer owns the store and each KGrRunner reads and writes its own
+ * items in the store through accessors, as if they were its own variables.
+ * Positions and directions are changed only by setPosition() and
+ * setDirection(), which keep a hash of them up to date (see KGrZobrist).
+ *
+ * @short   KGoldrunner Runner State Arrays
+ */
+
+class KGrRunnerStore
+{
+public:
+    KGrRunnerStore() : hash (0) {}
+
+    /**
+     * Make room in the store for a runner.
+     *
+     * @param spriteId     The sprite ID of the runner.
+     */
+    inline void add (const int spriteId) {
+        int oldCount = gridX.count();
+        if (oldCount <= spriteId) {
+            gridX.resize     (spriteId + 1);
+            gridY.resize     (spriteId + 1);
+            timeLeft.resize  (spriteId + 1);
+            direction.resize (spriteId + 1);
+            for (int id = oldCount; id <= spriteId; id++) {
+                hash ^= positionKey (id) ^ directionKey (id);
+            }
+        }
+    }
+
+    /**
+     * Move a runner to a new position.
+     *
+     * @param spriteId     The sprite ID of the runner.
+     * @param x            The X-position in grid-points.
+     * @param y            The Y-position in grid-points.
+     */
+    inline void setPosition (const int spriteId, const int x, const int y) {
+        hash ^= positionKey (spriteId);
+        gridX [spriteId] = x;
+        gridY [spriteId] = y;
+        hash ^= positionKey (spriteId);
+    }
+
+    /**
+     * Set the direction in which a runner is running.
+     *
+     * @param spriteId     The sprite ID of the runner.
+     * @param dirn         The direction.
+     */
+    inline void setDirection (const int spriteId, const Direction dirn) {
+        hash ^= directionKey (spriteId);
+        direction [spriteId] = dirn;
+        hash ^= directionKey (spriteId);
+    }
+
+    /**
+     * Returns the number of ticks for which a runner will do nothing but wait
+     * for its next action, if each tick is of the given scaled time.  The
+     * runner's state at the end of the wait is the same as if it had been run
+     * that many times (see KGrRunner::situation()) or had skipTicks() called.
+     *
+     * @param spriteId     The sprite ID of the runner.
+     * @param scaledTime   The scaled time of one tick.
+     */
+    inline int ticksToWait (const int spriteId, const int scaledTime) const {
+        return (scaledTime > 0) ?
+               std::max (timeLeft [spriteId] / scaledTime - 1, 0) : 0;
+    }
+
+    /**
+     * Lets some ticks go by, in which a runner would do nothing but wait.
+     *
+     * @param spriteId     The sprite ID of the runner.
+     * @param ticks        The number of ticks (see ticksToWait()).
+     * @param scaledTime   The scaled time of one tick.
+     */
+    inline void skipTicks (const int spriteId, const int ticks,
+                           const int scaledTime) {
+        timeLeft [spriteId] -= ticks * scaledTime;
+    }
+
+    QList<int>       gridX;		///< X-position in grid-points.
+    QList<int>       gridY;		///< Y-position in grid-points.
+    QList<int>       timeLeft;		///< Time till the runner's next action.
+    QList<Direction> direction;		///< Direction in which it is running.
+
+    /// A hash of the positions and directions of all the runners, for
+    /// KGrLevelPlayer::stateHash().  The times are not included.
+    quint64          hash;
+
+private:
+    inline quint64 positionKey (const int spriteId) const {
+        return KGrZobrist::key (KGrZobrist::RunnerPosition, spriteId,
+                                gridX.at (spriteId), gridY.at (spriteId));
+    }
+
+    inline quint64 directionKey (const int spriteId) const {
+        return KGrZobrist::key (KGrZobrist::RunnerDirection, spriteId,
+                                direction.at (spriteId));
+    }
+};
+
+#endif // KGRRUNNERSTORE_H
@@ -24,7 +24,8 @@ const StartFrame animationStartFrames [nAnimationTypes] = {
 KGrScene::KGrScene      (KGrView * view)
     :
     QGraphicsScene      (view),
-    // Allow FIELDWIDTH * FIELDHEIGHT tiles for the KGoldruner level-layouts,
+    // Allow FIELDWIDTH * FIELDHEIGHT tiles for the KGoldruner level-layouts
+    // (until setGridSize() is called for a level of a different size),
     // plus 2 more tile widths all around for text areas, frame and spillover
     // for mouse actions (to avoid accidental clicks affecting the desktop).
     m_view              (view),
@@ -36,6 +37,11 @@ KGrScene::KGrScene      (KGrView * view)
     m_scoreText         (nullptr),
     m_hasHintText       (nullptr),
     m_pauseResumeText   (nullptr),
+    m_timeline          (nullptr),
+    m_timelinePlayed    (nullptr),
+    m_replayTick        (0),
+    m_replayLength      (0),
+    m_warningTopRow     (false),
     m_heroId            (0),
     m_tilesWide         (FIELDWIDTH  + 2 * 2),
     m_tilesHigh         (FIELDHEIGHT + 2 * 2),
@@ -79,6 +85,11 @@ KGrScene::KGrScene      (KGrView * view)
     m_pauseResumeText = new QGraphicsSimpleTextItem();
     addItem (m_pauseResumeText);
 
+    m_timeline = addRect (0, 0, 100, 10);	// Visible only in some replays.
+    m_timeline->setVisible (false);
+    m_timelinePlayed = addRect (0, 0, 100, 10);
+    m_timelinePlayed->setVisible (false);
+
     m_fadingTimeLine->setEasingCurve(QEasingCurve::OutCurve);
     m_fadingTimeLine->setUpdateInterval (50);
     connect(m_fadingTimeLine, &QTimeLine::valueChanged, this, &KGrScene::drawSpotlight);
@@ -156,6 +167,8 @@ void KGrScene::redrawScene ()
     setTextFont (m_title, 0.6);
     setTitle (m_title->text());
     placeTextItems();
+    placeTimeline();
+    placeEditWarnings();
 
     // Resize and draw different backgrounds, depending on the level and theme.
     loadBackground (m_level);
@@ -179,8 +192,8 @@ void KGrScene::redrawScene ()
         drawBorder();
 
         // Redraw all the tiles, except for borders and tiles of type FREE.
-        for (int i = 1; i <= FIELDWIDTH; i++) {
-            for (int j = 1; j <= FIELDHEIGHT; j++) {
+        for (int i = 1; i <= m_tilesWide - 4; i++) {
+            for (int j = 1; j <= m_tilesHigh - 4; j++) {
                 int index = i * m_tilesHigh + j;
                 paintCell (i, j, m_tileTypes[index]);
             }
@@ -229,6 +242,90 @@ void KGrScene::showReplayMessage (bool onOff)
     m_replayMessage->setVisible (onOff);
 }
 
+void KGrScene::setReplayProgress (const int tick, const int length)
+{
+    m_replayTick   = tick;
+    m_replayLength = length;
+    placeTimeline();
+}
+
+int KGrScene::replayTickAt (const QPointF & point) const
+{
+    if ((m_replayLength <= 0) || (! m_timeline->contains (point))) {
+        return -1;
+    }
+    QRectF r = m_timeline->rect();
+    return qRound (m_replayLength * (point.x() - r.left()) / r.width());
+}
+
+void KGrScene::placeTimeline()
+{
+    bool visible = (m_replayLength > 0);
+    m_timeline->setVisible (visible);
+    m_timelinePlayed->setVisible (visible);
+    if (! visible) {
+        return;
+    }
+
+    // Place the timeline in the row of tiles below the playing area.
+    qreal x      = m_topLeftX + 2 * m_tileSize;
+    qreal y      = m_topLeftY + (m_tilesHigh - 2) * m_tileSize +
+                   0.35 * m_tileSize;
+    qreal width  = (m_tilesWide - 4) * m_tileSize;
+    qreal height = 0.3 * m_tileSize;
+    qreal played = qBound (0.0, (qreal) m_replayTick / m_replayLength, 1.0);
+
+    m_timeline->setRect (x, y, width, height);
+    m_timeline->setPen (QPen (m_renderer->textColor()));
+    m_timeline->setBrush (Qt::NoBrush);
+    m_timeline->setZValue (10);
+
+    m_timelinePlayed->setRect (x, y, played * width, height);
+    m_timelinePlayed->setPen (Qt::NoPen);
+    m_timelinePlayed->setBrush (m_renderer->textColor());
+    m_timelinePlayed->setZValue (10);
+}
+
+void KGrScene::setEditWarnings (const QList<int> & cells, const bool topRow)
+{
+    m_warningCells  = cells;
+    m_warningTopRow = topRow;
+    placeEditWarnings();
+}
+
+void KGrScene::placeEditWarnings()
+{
+    // Keep one mark for each cell and one for the top row, if it is needed.
+    int marks = m_warningCells.count() + (m_warningTopRow ? 1 : 0);
+    while (m_editWarnings.count() < marks) {
+        m_editWarnings.append (addRect (0, 0, 10, 10));
+    }
+    while (m_editWarnings.count() > marks) {
+        delete m_editWarnings.takeLast();
+    }
+
+    const int width = m_tilesWide - 4;
+    for (int n = 0; n < marks; n++) {
+        QGraphicsRectItem * mark = m_editWarnings.at (n);
+        if (n < m_warningCells.count()) {
+            int i = m_warningCells.at (n) % width + 1;
+            int j = m_warningCells.at (n) / width + 1;
+            mark->setRect (m_topLeftX + (i + 1) * m_tileSize,
+                           m_topLeftY + (j + 1) * m_tileSize,
+                           m_tileSize, m_tileSize);
+        }
+        else {
+            // The top row, drawn as a bar along the top edge of the layout.
+            mark->setRect (m_topLeftX + 2 * m_tileSize,
+                           m_topLeftY + 2 * m_tileSize,
+                           width * m_tileSize, 0.2 * m_tileSize);
+        }
+        mark->setPen (QPen (Qt::red));
+        mark->setBrush (QColor (255, 0, 0, 80));
+        mark->setZValue (10);
+    }
+}
+
 void KGrScene::placeTextItems()
 {
     setTextFont (m_replayMessage, 0.5);
@@ -371,29 +468,50 @@ void KGrScene::setBorderTile (const QString &spriteKey, const int x, const int y
     }
 }
 
+void KGrScene::setGridSize (const int width, const int height)
+{
+    if ((width + 2 * 2 == m_tilesWide) && (height + 2 * 2 == m_tilesHigh)) {
+        return;
+    }
+
+    // Delete all tiles, including any border-tiles, and lay out the scene.
+    qDeleteAll (m_tiles);
+    m_tilesWide = width  + 2 * 2;
+    m_tilesHigh = height + 2 * 2;
+    m_tiles.fill        (nullptr, m_tilesWide * m_tilesHigh);
+    m_tileTypes.fill    (FREE,    m_tilesWide * m_tilesHigh);
+
+    m_sizeChanged  = true;
+    m_themeChanged = true;		// Makes redrawScene() draw a new border.
+    redrawScene();
+}
+
 void KGrScene::drawBorder()
 {
+    const int width  = m_tilesWide - 4;
+    const int height = m_tilesHigh - 4;
+
     // Corners.
     setBorderTile (QStringLiteral("frame-topleft"), 0, 0);
-    setBorderTile (QStringLiteral("frame-topright"), FIELDWIDTH + 1, 0);
-    setBorderTile (QStringLiteral("frame-bottomleft"), 0, FIELDHEIGHT + 1);
-    setBorderTile (QStringLiteral("frame-bottomright"), FIELDWIDTH + 1, FIELDHEIGHT + 1);
+    setBorderTile (QStringLiteral("frame-topright"), width + 1, 0);
+    setBorderTile (QStringLiteral("frame-bottomleft"), 0, height + 1);
+    setBorderTile (QStringLiteral("frame-bottomright"), width + 1, height + 1);
 
     // Upper side.
-    for (int i = 1; i <= FIELDWIDTH; i++)
+    for (int i = 1; i <= width; i++)
         setBorderTile (QStringLiteral("frame-top"), i, 0);
 
     // Lower side.
-    for (int i = 1; i <= FIELDWIDTH; i++)
-        setBorderTile (QStringLiteral("frame-bottom"), i, FIELDHEIGHT + 1);
+    for (int i = 1; i <= width; i++)
+        setBorderTile (QStringLiteral("frame-bottom"), i, height + 1);
 
     // Left side.
-    for (int i = 1; i <= FIELDHEIGHT; i++)
+    for (int i = 1; i <= height; i++)
         setBorderTile (QStringLiteral("frame-left"), 0, i);
 
     // Right side.
-    for (int i = 1; i <= FIELDHEIGHT; i++)
-        setBorderTile (QStringLiteral("frame-right"), FIELDWIDTH + 1, i);
+    for (int i = 1; i <= height; i++)
+        setBorderTile (QStringLiteral("frame-right"), width + 1, i);
 }
 
 void KGrScene::drawFrame()
@@ -403,8 +521,8 @@ void KGrScene::drawFrame()
     m_frame->setRect (
 	m_topLeftX + (2 * m_tileSize) - (3 * w),
 	m_topLeftY + (2 * m_tileSize) - (3 * w),
-	FIELDWIDTH  * m_tileSize + 6 * w,
-	FIELDHEIGHT * m_tileSize + 6 * w);
+	(m_tilesWide - 4) * m_tileSize + 6 * w,
+	(m_tilesHigh - 4) * m_tileSize + 6 * w);
     //qCDebug(KGOLDRUNNER_LOG) << "FRAME WIDTH" << w << "tile size" << m_tileSize << "rectangle" << m_frame->rect();
     QPen pen = QPen (m_renderer->textColor());
     pen.setWidth (w);
@@ -424,21 +542,16 @@ void KGrScene::paintCell (const int i, const int j, const char type)
     }
 }
 
-int KGrScene::makeSprite (const char type, int i, int j)
+void KGrScene::makeSprite (const int spriteId, const char type, int i, int j)
 {
-    int spriteId;
     KGrSprite * sprite = m_renderer->getSpriteItem (type, TickTime);
 
-    if (m_sprites.count(nullptr) > 0 &&
-        ((spriteId = m_sprites.lastIndexOf (nullptr)) >= 0)) {
-        // Re-use a slot previously occupied by a transient member of the list.
-        m_sprites[spriteId] = sprite;
-    }
-    else {
-        // Otherwise, add to the end of the list.
-        spriteId = m_sprites.count();
-        m_sprites.append (sprite);
+    // The game-engine chooses the ID, which may re-use the slot of a transient
+    // member of the list (a dug brick that has closed).
+    while (m_sprites.count() <= spriteId) {
+        m_sprites.append (nullptr);
     }
+    m_sprites [spriteId] = sprite;
 
     int frame1 = animationStartFrames [FALL_L];
 
@@ -467,7 +580,6 @@ int KGrScene::makeSprite (const char type, int i, int j)
     sprite->setCoordinateSystem (m_topLeftX, m_topLeftY, m_tileSize);
     addItem (sprite);		// The sprite can be correctly rendered now.
     sprite->move (i, j, frame1);
-    return spriteId;
 }
 
 void KGrScene::animate (bool missed)
@@ -618,8 +730,10 @@ void KGrScene::getMousePos (int & i, int & j)
     j = (j - m_topLeftY)/m_tileSize - 1;
 
     // Make sure i and j are within the KGoldrunner playing area.
-    i = (i < 1) ? 1 : ((i > FIELDWIDTH)  ? FIELDWIDTH  : i);
-    j = (j < 1) ? 1 : ((j > FIELDHEIGHT) ? FIELDHEIGHT : j);
+    const int width  = m_tilesWide - 4;
+    const int height = m_tilesHigh - 4;
+    i = (i < 1) ? 1 : ((i > width)  ? width  : i);
+    j = (j < 1) ? 1 : ((j > height) ? height : j);
 }
 
 void KGrScene::setTextFont (QGraphicsSimpleTextItem * t, double fontFraction)
@@ -10,7 +10,9 @@
  *
  * In the KGoldrunner scene, the KGoldrunner level-layouts use tile-coordinates
  * that run from (1, 1) to (28, 20). To simplify programming, these are exactly
- * the same as the cell co-ordinates used in the game-engine (or model).
+ * the same as the cell co-ordinates used in the game-engine (or model). Levels
+ * of other sizes are allowed (see setGridSize()) and the numbers below change
+ * accordingly.
  *
  * The central grid has internal coordinates running from (-1, -1) to (30, 22),
  * making 32x24 spaces. The empty space around the level-layout (2 cells wide
@@ -39,6 +41,7 @@
 #include <QGraphicsScene>
 
 #include "kgrglobals.h"
+#include "kgrlevelobserver.h"
 
 class KGrView;
 class KGrSprite;
@@ -60,7 +63,7 @@ enum StartFrame     {RIGHTWALK1 = 1,  RIGHTWALK2,  RIGHTWALK3,  RIGHTWALK4,
                      DIGBRICK5,
                      DIGBRICK6, DIGBRICK7, DIGBRICK8, DIGBRICK9};
 
-class KGrScene : public QGraphicsScene
+class KGrScene : public QGraphicsScene, public KGrLevelObserver
 {
     Q_OBJECT
 public:
@@ -95,6 +98,37 @@ public:
 
     void showReplayMessage (bool onOff);
 
+    /**
+     * Show how far a replay has gone, on a timeline below the playing area,
+     * which can be clicked or dragged to go to another point in the replay.
+     *
+     * @param tick          The tick the replay has reached.
+     * @param length        The number of ticks in the replay, or 0 to hide
+     *                      the timeline.
+     */
+    void setReplayProgress (const int tick, const int length);
+
+    /**
+     * Find where a point on the timeline is in the replay.
+     *
+     * @param point         A point in scene coordinates.
+     *
+     * @return              The tick at that point, or -1 if the point is not on
+     *                      the timeline or the timeline is hidden.
+     */
+    int  replayTickAt (const QPointF & point) const;
+
+    /**
+     * Show the warnings found by the game editor's check of a level (see
+     * KGrLevelChecker), as red marks over the cells, until they are replaced.
+     *
+     * @param cells         The cells of gold that the hero cannot reach, as
+     *                      offsets in the layout (i - 1 + (j - 1) * width).
+     * @param topRow        If true, also mark the top row: the hero cannot
+     *                      reach it after collecting the gold.
+     */
+    void setEditWarnings (const QList<int> & cells, const bool topRow);
+
     void setHasHintText (const QString & msg);
 
     void setPauseResumeText (const QString & msg);
@@ -113,20 +147,30 @@ public:
      */
     KGrRenderer * renderer  () const { return m_renderer; }
 
-    inline void setGoldEnemiesRule (bool showIt) { enemiesShowGold = showIt; }
+    inline void setGoldEnemiesRule (bool showIt) override {
+                                     enemiesShowGold = showIt; }
+
+    /**
+     * Set the size of the level-layout, in tiles.  If it has changed, all
+     * tiles are erased and the scene is laid out again for the new size.
+     */
+    void setGridSize        (const int width, const int height) override;
 
 public Q_SLOTS:
     void showLives          (long lives);
 
     void showScore          (long score);
 
-    int  makeSprite         (const char type, int i, int j);
+    void makeSprite         (const int spriteId, const char type,
+                             int i, int j) override;
 
-    void animate            (bool missed);
+    void animate            (bool missed) override;
     void gotGold            (const int spriteId, const int i, const int j,
-                             const bool spriteHasGold, const bool lost = false);
-    void showHiddenLadders  (const QList<int> & ladders, const int width);
-    void deleteSprite       (const int id);
+                             const bool spriteHasGold,
+                             const bool lost = false) override;
+    void showHiddenLadders  (const QList<int> & ladders,
+                             const int width) override;
+    void deleteSprite       (const int id) override;
     void deleteAllSprites   ();
 
     /**
@@ -140,7 +184,8 @@ public Q_SLOTS:
      * @param j            The row-number of the cell to paint.
      * @param type         The type of tile to paint (gold, brick, ladder, etc).
      */
-    void paintCell          (const int i, const int j, const char type);
+    void paintCell          (const int i, const int j,
+                             const char type) override;
 
     /**
      * Requests the view to display an animation of a runner or dug brick at a
@@ -156,7 +201,8 @@ public Q_SLOTS:
      */
     void startAnimation    (const int id, const bool repeating,
                             const int i, const int j, const int time,
-                            const Direction dirn, const AnimationType type);
+                            const Direction dirn,
+                            const AnimationType type) override;
 
     /**
      * Just as the game starts, ensure that all frames of the "hero" and "enemy"
@@ -165,8 +211,8 @@ public Q_SLOTS:
      */
     void preRenderSprites();
 
-    void setMousePos (const int i, const int j);
-    void getMousePos (int & i, int & j);
+    void setMousePos (const int i, const int j) override;
+    void getMousePos (int & i, int & j) override;
 
 Q_SIGNALS:
     void fadeFinished();
@@ -231,6 +277,17 @@ private:
     QGraphicsSimpleTextItem * m_hasHintText;
     QGraphicsSimpleTextItem * m_pauseResumeText;
 
+    // Timeline of a replay and the part of it that has been played.
+    QGraphicsRectItem   *   m_timeline;
+    QGraphicsRectItem   *   m_timelinePlayed;
+    int                     m_replayTick;
+    int                     m_replayLength;
+
+    // Warnings from the game editor, each a mark over a cell or the top row.
+    QList <QGraphicsRectItem *> m_editWarnings;
+    QList <int>             m_warningCells;
+    bool                    m_warningTopRow;
+
     int                     m_heroId;
     int                     m_tilesWide;
     int                     m_tilesHigh;
@@ -259,6 +316,8 @@ private:
 
     void setTextFont (QGraphicsSimpleTextItem * t, double fontFraction);
     void placeTextItems();
+    void placeTimeline();
+    void placeEditWarnings();
 
     QGraphicsRectItem * m_spotlight;		// Fade-out/fade-in item.
     QTimeLine *         m_fadingTimeLine;	// Timing for fade-out/fade-in.
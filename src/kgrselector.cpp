@@ -617,7 +617,9 @@ void KGrGameListItem::setId (const int internalId)
 KGrThumbNail::KGrThumbNail (QWidget * parent)
     :
     QFrame (parent),
-    io     (new KGrGameIO (parent))
+    io     (new KGrGameIO (parent)),
+    levelWidth  (FIELDWIDTH),
+    levelHeight (FIELDHEIGHT)
 {
     // Let the parent do all the work.  We need a class here so that
     // QFrame::paintEvent (QPaintEvent *) can be re-implemented and
@@ -639,11 +641,15 @@ void KGrThumbNail::setLevelData (const QString & dir, const QString& prefix,
     if (stat == OK) {
         // Keep a safe copy of the layout.  Translate and display the name.
         levelLayout = d.layout;
+        levelWidth  = d.width;
+        levelHeight = d.height;
         sln->setText ((d.name.size() > 0) ? i18n (d.name.constData()) : QString());
     }
     else {
         // Level-data inaccessible or not found.
         levelLayout = "";
+        levelWidth  = FIELDWIDTH;
+        levelHeight = FIELDHEIGHT;
         sln->setText (QString());
     }
 }
@@ -655,7 +661,8 @@ void KGrThumbNail::paintEvent (QPaintEvent * /* event (unused) */)
     QPen	pen = p.pen();
     char	obj = FREE;
     int		fw = 1;				// Set frame width.
-    int		n = width() / FIELDWIDTH;	// Set thumbnail cell-size.
+    int		n = qMin (width()  / levelWidth,	// Set thumbnail cell-size.
+                          height() / levelHeight);
 
     QColor backgroundColor = QColor (0x00, 0x00, 0x38); // Midnight blue.
     QColor brickColor =      QColor (0x9c, 0x0f, 0x0f); // Oxygen's brick-red.
@@ -669,16 +676,23 @@ void KGrThumbNail::paintEvent (QPaintEvent * /* event (unused) */)
     pen.setColor (backgroundColor);
     p.setPen (pen);
 
-    if (levelLayout.isEmpty()) {
+    if (n < 1) {
+        // A very large level: draw one pixel per cell and scale it down.
+        p.scale ((width()  - 2 * fw) / double (levelWidth),
+                 (height() - 2 * fw) / double (levelHeight));
+        n = 1;
+    }
+
+    if (levelLayout.size() < levelWidth * levelHeight) {
         // There is no file, so fill the thumbnail with "FREE" cells.
-        p.drawRect (QRect (fw, fw, FIELDWIDTH*n, FIELDHEIGHT*n));
+        p.drawRect (QRect (fw, fw, levelWidth*n, levelHeight*n));
         return;
     }
 
-    for (int j = 0; j < FIELDHEIGHT; j++)
-    for (int i = 0; i < FIELDWIDTH; i++) {
+    for (int j = 0; j < levelHeight; j++)
+    for (int i = 0; i < levelWidth; i++) {
 
-        obj = levelLayout.at (j*FIELDWIDTH + i);
+        obj = levelLayout.at (j*levelWidth + i);
 
         // Set the colour of each object.
         switch (obj) {
@@ -120,6 +120,8 @@ private:
     KGrGameIO * io;
     QByteArray  levelName;
     QByteArray  levelLayout;
+    int         levelWidth;			// Size of the level-layout.
+    int         levelHeight;
     QLabel *    lName;				// Place to write level-name.
 };
 
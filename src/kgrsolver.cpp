@@ -0,0 +1,412 @@
+/*
+    SPDX-FileCopyrightText: 2026 The KGoldrunner Developers
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#include "kgrsolver.h"
+#include "kgrdistancefield.h"
+#include "kgrlevelgrid.h"
+#include "kgrlevelobserver.h"
+#include "kgrlevelplayer.h"
+#include "kgrrandom.h"
+#include "kgrdebug.h"
+
+#include <QDateTime>
+#include <QMap>
+#include <QMutexLocker>
+#include <QRunnable>
+#include <QThread>
+#include <QThreadPool>
+
+/// A state of the level, waiting to be searched.
+class KGrSolver::Node
+{
+public:
+    QByteArray               path;	// The moves from the start.
+    KGrLevelPlayer::Snapshot snapshot;	// The state, as taken by the owner.
+    int                      owner;	// The worker whose player took it.
+};
+
+/// A worker thread, with its own level player and queue of states.
+class KGrSolver::Worker : public QRunnable
+{
+public:
+    Worker (KGrSolver * pSolver, const int pId);
+
+    void run() override;
+
+    // Add a state to the queue.  Lower priorities are searched first.
+    void push  (const Node & node, const int priority);
+
+    // Take the last state added with the best priority, to search it here.
+    bool take  (Node & node);
+
+    // Take the first state added with the best priority, for another worker.
+    bool steal (Node & node);
+
+private:
+    // Try out all the moves from a state and queue the new states reached.
+    void expand (Node & node);
+
+    // The number of the hero's moves from cell (i, j) to the nearest gold or,
+    // if there is no gold left, to the top row.
+    int  goalDistance (const int i, const int j);
+
+    KGrSolver *              solver;
+    int                      id;
+    KGrLevelPlayer *         player;	// Exists only while run() is running.
+    KGrLevelPlayer::Snapshot start;	// The level before the first move.
+    KGrDistanceField         goal;	// Moves to the gold or the top row.
+    int                      goalChanges;	// Grid change-count, as in goal.
+
+    QMutex                   lock;
+    QMap<int, QList<Node> >  queue;	// States, in buckets by priority,
+					// with no empty buckets.
+};
+
+/**
+ * Make one move of the search: press a key, then run the level until the hero
+ * reaches the centre of another cell or, if he does not move, for as long as
+ * he would take to walk one cell.
+ *
+ * @return  The result: NORMAL, WON_LEVEL, DEAD or UNEXPECTED_END.
+ */
+static int playMove (KGrLevelPlayer & player, const int action)
+{
+    int x0, y0, x, y;
+    const int pointsPerCell = player.heroPosition (x0, y0);
+
+    // The hero takes between 2 and 3 ticks to move one point at normal speed.
+    const int maxTicks = 8 * pointsPerCell;
+
+    player.setDirectionByKey ((Direction) action, true);
+    for (int n = 0; n < maxTicks; n++) {
+        int result = player.runFixedStep (1);
+        if (result != NORMAL) {
+            return result;
+        }
+        player.heroPosition (x, y);
+        if (((x % pointsPerCell) == 0) && ((y % pointsPerCell) == 0) &&
+            ((x != x0) || (y != y0))) {
+            break;
+        }
+        if ((x == x0) && (y == y0) && (n >= 3 * pointsPerCell)) {
+            break;			// The hero is standing, digging or stuck.
+        }
+    }
+    return NORMAL;
+}
+
+KGrSolver::Worker::Worker (KGrSolver * pSolver, const int pId)
+    :
+    solver      (pSolver),
+    id          (pId),
+    player      (nullptr),
+    goalChanges (-1)
+{
+    setAutoDelete (false);		// The solver deletes its workers.
+}
+
+void KGrSolver::Worker::run()
+{
+    KGrLevelObserver observer;		// No graphics: all calls do nothing.
+    KGrRecording     recording = solver->level;
+    KGrLevelPlayer   levelPlayer (nullptr, nullptr);
+
+    levelPlayer.init (&observer, &recording, false, false, false);
+    levelPlayer.setTimeScale (recording.speed);
+    levelPlayer.prepareToPlay();
+    player      = &levelPlayer;
+    start       = levelPlayer.saveState();
+    goalChanges = -1;
+
+    Node node;
+    while (solver->stopped.loadAcquire() == 0) {
+        bool found = take (node);
+        for (int n = 1; (! found) && (n < solver->workers.count()); n++) {
+            found = solver->workers.at ((id + n) % solver->workers.count())
+                                                    ->steal (node);
+        }
+        if (found) {
+            expand (node);
+            solver->pending.fetchAndAddOrdered (-1);
+        }
+        else if (solver->pending.loadAcquire() == 0) {
+            break;				// There is nothing left to search.
+        }
+        else {
+            QThread::yieldCurrentThread();	// Others are still searching.
+        }
+    }
+    player = nullptr;
+    start  = KGrLevelPlayer::Snapshot();
+}
+
+void KGrSolver::Worker::push (const Node & node, const int priority)
+{
+    // The priorities can run into millions on a large level, so the buckets
+    // are kept in a map, not in a list indexed by priority.
+    QMutexLocker locker (&lock);
+    queue [priority].append (node);
+}
+
+bool KGrSolver::Worker::take (Node & node)
+{
+    QMutexLocker locker (&lock);
+    if (queue.isEmpty()) {
+        return false;
+    }
+    auto best = queue.begin();
+    node = best->takeLast();
+    if (best->isEmpty()) {
+        queue.erase (best);
+    }
+    return true;
+}
+
+bool KGrSolver::Worker::steal (Node & node)
+{
+    QMutexLocker locker (&lock);
+    if (queue.isEmpty()) {
+        return false;
+    }
+    auto best = queue.begin();
+    node = best->takeFirst();
+    if (best->isEmpty()) {
+        queue.erase (best);
+    }
+    return true;
+}
+
+void KGrSolver::Worker::expand (Node & node)
+{
+    // A state taken by another worker's level player has to be reached again
+    // in this one, from the start.
+    if (node.owner != id) {
+        player->restoreState (start);
+        for (const char action : std::as_const(node.path)) {
+            if (playMove (*player, action) != NORMAL) {
+                dbk << "Worker" << id << "could not reach a state again";
+                return;
+            }
+        }
+        node.snapshot = player->saveState();
+        node.owner    = id;
+    }
+
+    for (int action = STAND; action < Actions; action++) {
+        player->restoreState (node.snapshot);
+        int result = playMove (*player, action);
+
+        QByteArray path = node.path;
+        path.append ((char) action);
+        if (result == WON_LEVEL) {
+            solver->foundWay (path);
+            return;
+        }
+        if (solver->limitReached()) {
+            return;
+        }
+        if ((result != NORMAL) || (! solver->markSeen (player->stateHash()))) {
+            continue;			// The hero died or has been here before.
+        }
+
+        // Search states with less gold first, then with the hero nearer to
+        // the next piece of gold, or to the top row if the gold has all gone.
+        int x, y;
+        int pointsPerCell = player->heroPosition (x, y);
+        int cells         = player->levelGrid()->gridWidth() *
+                            (solver->level.height + 2 * ConcreteWall);
+        int distance      = goalDistance (x / pointsPerCell, y / pointsPerCell);
+        int priority      = player->goldLeft() * (cells + 1) +
+                            qMin (distance, cells);
+
+        Node child;
+        child.path     = path;
+        child.snapshot = player->saveState();
+        child.owner    = id;
+        solver->pending.fetchAndAddOrdered (1);
+        push (child, priority);
+    }
+}
+
+int KGrSolver::Worker::goalDistance (const int i, const int j)
+{
+    // Build the field again only if the grid has changed since it was built
+    // (e.g. by restoring a state or picking up gold).
+    KGrLevelGrid * grid = player->levelGrid();
+    if (grid->changeCount() != goalChanges) {
+        QList<int> targets;
+        int  width  = grid->gridWidth();
+        int  height = grid->levelHeight() + 2 * ConcreteWall;
+        bool gold   = (player->goldLeft() > 0);
+        for (int j = 1; j < height - 1; j++) {
+            for (int i = 1; i < width - 1; i++) {
+                bool target = gold ? (grid->cellType (i, j) == NUGGET) :
+                              ((j == 1) &&
+                               (grid->heroMoves (i, j) & dFlag [STAND]));
+                if (target) {
+                    targets.append (i + j * width);
+                }
+            }
+        }
+        goal.build (grid, targets, true);
+        goalChanges = grid->changeCount();
+    }
+    return goal.distance (i, j);
+}
+
+KGrSolver::KGrSolver (const KGrRecording & pLevel, const int threads)
+    :
+    level       (pLevel),
+    threadCount ((threads > 0) ? threads : QThread::idealThreadCount()),
+    maxStates   (1000000),
+    timeLimit   (0),
+    states      (0),
+    pending     (0),
+    stopped     (0),
+    cancelled   (0),
+    elapsedTime (0),
+    ticks       (0)
+{
+    // The enemies must do the same things in every try, so there must be a
+    // seed: the random numbers cannot be drawn from a shared generator.
+    if (level.seed == 0) {
+        level.seed = KGrRandom::DefaultSeed;
+    }
+    level.draws.clear();
+    level.checks.clear();
+    level.content = QByteArray (1, static_cast<char>(END_CODE));
+}
+
+KGrSolver::~KGrSolver()
+{
+    qDeleteAll (workers);
+}
+
+void KGrSolver::setUpLevel (KGrRecording & level, const KGrGameData & game,
+                            const KGrLevelData & levelData, const int levelNo)
+{
+    level.dateTime        = QDateTime::currentDateTime()
+                                          .toUTC()
+                                          .toString (Qt::ISODate);
+    level.owner           = game.owner;
+    level.rules           = game.rules;
+    level.prefix          = game.prefix;
+    level.gameName        = game.name;
+
+    level.level           = levelNo;
+    level.width           = levelData.width;
+    level.height          = levelData.height;
+    level.layout          = levelData.layout;
+    level.digWhileFalling = levelData.digWhileFalling;
+    level.levelName       = QString::fromUtf8 (levelData.name);
+    level.hint            = QString::fromUtf8 (levelData.hint);
+
+    level.lives           = 5;
+    level.score           = 0;
+    level.speed           = 10;		// Normal speed.
+    level.controlMode     = KEYBOARD;
+    level.keyOption       = CLICK_KEY;
+    level.content         = QByteArray (1, static_cast<char>(END_CODE));
+    level.draws.clear();
+    level.checks.clear();
+    level.seed            = KGrRandom::DefaultSeed;
+}
+
+bool KGrSolver::solve (KGrRecording & solution)
+{
+    clock.start();
+    states.storeRelaxed (0);
+    pending.storeRelaxed (1);		// The start of the level.
+    stopped.storeRelaxed (cancelled.loadAcquire());
+    way.clear();
+    ticks = 0;
+    for (int n = 0; n < Shards; n++) {
+        seen [n].clear();
+    }
+
+    qDeleteAll (workers);
+    workers.clear();
+    for (int n = 0; n < threadCount; n++) {
+        workers.append (new Worker (this, n));
+    }
+
+    // The start has no snapshot yet: whichever worker takes it plays no moves
+    // to reach it and saves its own starting snapshot.
+    Node start;
+    start.owner = -1;
+    workers.first()->push (start, 0);
+
+    QThreadPool pool;
+    pool.setMaxThreadCount (threadCount);
+    for (Worker * worker : std::as_const(workers)) {
+        pool.start (worker);
+    }
+    pool.waitForDone();
+
+    // Play the winning moves again from the start, to make the recording.
+    bool won = false;
+    if ((! way.isEmpty()) && (cancelled.loadAcquire() == 0)) {
+        KGrLevelObserver observer;
+        KGrLevelPlayer   player (nullptr, nullptr);
+        int              result = NORMAL;
+
+        solution = level;
+        player.init (&observer, &solution, false, false, false);
+        player.setTimeScale (solution.speed);
+        player.prepareToPlay();
+        for (const char action : std::as_const(way)) {
+            result = playMove (player, action);
+            if (result != NORMAL) {
+                break;
+            }
+        }
+        ticks = player.tickCount();
+        won   = (result == WON_LEVEL);
+        if (! won) {
+            dbk << "Level" << level.prefix << level.level
+                << "was not won when the solution was played again";
+        }
+    }
+    elapsedTime = clock.elapsed();
+    return won;
+}
+
+void KGrSolver::stop()
+{
+    cancelled.storeRelease (1);
+    stopped.storeRelease (1);
+}
+
+bool KGrSolver::markSeen (const quint64 hash)
+{
+    int        shard = (int) (hash % Shards);
+    QMutexLocker locker (&seenLock [shard]);
+    if (seen [shard].contains (hash)) {
+        return false;
+    }
+    seen [shard].insert (hash);
+    return true;
+}
+
+void KGrSolver::foundWay (const QByteArray & path)
+{
+    QMutexLocker locker (&wayLock);
+    if (way.isEmpty()) {
+        way = path;
+    }
+    stopped.storeRelease (1);
+}
+
+bool KGrSolver::limitReached()
+{
+    qint64 n = states.fetchAndAddRelaxed (1) + 1;
+    if ((n >= maxStates) ||
+        ((timeLimit > 0) && ((n % 256) == 0) &&
+         (clock.elapsed() > timeLimit))) {
+        stopped.storeRelease (1);
+    }
+    return (stopped.loadAcquire() != 0);
+}
@@ -0,0 +1,150 @@
+/*
+    SPDX-FileCopyrightText: 2026 The KGoldrunner Developers
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#ifndef KGRSOLVER_H
+#define KGRSOLVER_H
+
+#include "kgrglobals.h"
+
+#include <QAtomicInteger>
+#include <QByteArray>
+#include <QElapsedTimer>
+#include <QList>
+#include <QMutex>
+#include <QSet>
+
+/**
+ * The KGrSolver class searches for a way to win a level, by trying out the
+ * hero's moves in a KGrLevelPlayer running in fixed-step mode, with no timer
+ * and no graphics.  If it finds one, it plays the moves again from the start
+ * and returns the recording of that play, which can be saved as a sol_* file
+ * and shown by "Show a Solution", just like a solution recorded by a player.
+ *
+ * The level is played with the keyboard and the click-key option.  Each move
+ * of the search is a key (stand, left, right, up, down, dig left or dig right)
+ * followed by as many ticks as it takes for the hero to reach the centre of
+ * another cell, or a number of ticks equal to a few cells of walking if the
+ * hero stays where he is.  The state after each move is kept as a snapshot
+ * (see KGrLevelPlayer::saveState()) and states that have been reached before,
+ * according to KGrLevelPlayer::stateHash(), are not searched again.  The hash
+ * does not cover everything (e.g. the timing of each enemy's next step), so
+ * the search can miss a solution, but it cannot find a false one.
+ *
+ * The search is best-first: states with less gold left come first and then
+ * states with the hero fewer moves away from the nearest gold or, when all the
+ * gold has been collected, from the top row (see KGrDistanceField).  It runs
+ * on a pool of worker threads, each with its own level player and its own
+ * queue of states to search.  A worker with nothing to do takes a state from
+ * another worker's queue.  Snapshots can be restored only to the level player
+ * that took them, so each state also holds the moves that led to it and a
+ * worker that takes another worker's state plays those moves again from its
+ * own starting snapshot.
+ *
+ * The random numbers used by the enemies come from the seed of the recording
+ * (see KGrRandom), so the enemies do the same things in every try and in the
+ * final play, which makes the recording reproducible.
+ *
+ * @short   KGoldrunner Level Solver
+ */
+
+class KGrSolver
+{
+public:
+    /**
+     * The constructor of KGrSolver.
+     *
+     * @param level      The level to be solved, as set up by setUpLevel().
+     * @param threads    The number of worker threads, or 0 for one per core.
+     */
+    explicit KGrSolver (const KGrRecording & level, const int threads = 0);
+    ~KGrSolver();
+
+    /**
+     * Set up an empty recording of a level, ready for solving, with the
+     * control mode and other settings the solver needs.  The level name and
+     * hint are not translated.
+     *
+     * @param level      The recording to be set up.
+     * @param game       The game that contains the level.
+     * @param levelData  The level, as read by KGrGameIO.
+     * @param levelNo    The number of the level in the game.
+     */
+    static void setUpLevel (KGrRecording & level, const KGrGameData & game,
+                            const KGrLevelData & levelData, const int levelNo);
+
+    /// Stop the search after this many states have been reached (default one
+    /// million).  Each state waiting to be searched holds a snapshot.
+    inline void setMaxStates (const qint64 n)  { maxStates = n; }
+
+    /// Stop the search after this many milliseconds (default 0: no limit).
+    inline void setTimeLimit (const qint64 ms) { timeLimit = ms; }
+
+    /// Stop the search as soon as possible, without finding a way to win.  It
+    /// can be called from any thread, before or during solve().
+    void stop();
+
+    /**
+     * Search for a way to win the level.
+     *
+     * @param solution   The recording of the hero winning the level (return
+     *                   by reference), if a way is found.
+     *
+     * @return           True if a way to win the level has been found.
+     */
+    bool solve (KGrRecording & solution);
+
+    /// The number of states reached by the last search.
+    inline qint64 statesSearched() const { return states.loadRelaxed(); }
+
+    /// The time taken by the last search, in milliseconds.
+    inline qint64 elapsed()        const { return elapsedTime; }
+
+    /// The number of ticks in the solution found by the last search.
+    inline int    solutionTicks()  const { return ticks; }
+
+    /// The keys of a move: Direction values, from STAND to DIG_LEFT.
+    static constexpr int Actions = 7;
+
+private:
+    class Node;
+    class Worker;
+
+    // Record a state as reached.  Returns false if it was reached before.
+    bool markSeen     (const quint64 hash);
+
+    // Record the moves that win the level, if no other worker has done so.
+    void foundWay     (const QByteArray & path);
+
+    // Stop the search if it has reached the state or time limit.
+    bool limitReached ();
+
+    // The number of shards of the table of states reached, each with its own
+    // lock, so that the workers seldom have to wait for each other.
+    static constexpr int Shards = 64;
+
+    KGrRecording           level;		// The level, with no moves.
+    int                    threadCount;
+    qint64                 maxStates;
+    qint64                 timeLimit;
+    QList<Worker *>        workers;
+
+    QSet<quint64>          seen [Shards];	// Hashes of states reached.
+    QMutex                 seenLock [Shards];
+
+    QAtomicInteger<qint64> states;		// States reached so far.
+    QAtomicInteger<int>    pending;		// States queued or being searched.
+    QAtomicInteger<int>    stopped;		// Non-zero when search must end.
+    QAtomicInteger<int>    cancelled;		// Non-zero if stop() was called.
+
+    QMutex                 wayLock;
+    QByteArray             way;			// The moves that win, if found.
+
+    QElapsedTimer          clock;
+    qint64                 elapsedTime;
+    int                    ticks;
+};
+
+#endif // KGRSOLVER_H
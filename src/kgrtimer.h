@@ -21,7 +21,19 @@ public:
     void resume();
     void step();
     inline void setScale (const float pScale)
-                         { scaledTime = (pScale * tickTime) + 0.5; }
+                         { scaledTime = scaleTickTime (tickTime, pScale); }
+
+    /**
+     * Calculate the number of milliseconds per tick that is reported by the
+     * tick() signal when the speed of the game is scaled.  This is also used
+     * when a recording is replayed with no timer at all, so that the replay
+     * gets exactly the same values as when it is timed.
+     *
+     * @param pTickTime    The time of one tick in wall-clock time (msec).
+     * @param pScale       The speed factor (1.0 = normal speed).
+     */
+    static inline int scaleTickTime (const int pTickTime, const float pScale)
+                         { return (pScale * pTickTime) + 0.5; }
 
 Q_SIGNALS:
     /**
@@ -14,7 +14,8 @@
 KGrView::KGrView    (QWidget * parent)
     :
     QGraphicsView   (parent),
-    m_scene         (new KGrScene   (this))
+    m_scene         (new KGrScene   (this)),
+    m_seeking       (false)
 {
     setScene        (m_scene);
 }
@@ -33,16 +34,40 @@ void KGrView::resizeEvent (QResizeEvent *)
 
 void KGrView::mousePressEvent (QMouseEvent * mouseEvent)
 {
+    // A click on the timeline of a replay seeks and does not end the replay.
+    QPointF point = mapToScene (mouseEvent->position().toPoint());
+    int     tick  = m_scene->replayTickAt (point);
+    if (tick >= 0) {
+        m_seeking = true;
+        Q_EMIT seekReplay (tick);
+        return;
+    }
     Q_EMIT mouseClick (mouseEvent->button());
 }
 
+void KGrView::mouseMoveEvent (QMouseEvent * mouseEvent)
+{
+    if (m_seeking) {
+        QPointF point = mapToScene (mouseEvent->position().toPoint());
+        int     tick  = m_scene->replayTickAt (point);
+        if (tick >= 0) {
+            Q_EMIT seekReplay (tick);
+        }
+    }
+    QGraphicsView::mouseMoveEvent (mouseEvent);
+}
+
 void KGrView::mouseDoubleClickEvent (QMouseEvent * mouseEvent)
 {
-    Q_EMIT mouseClick (mouseEvent->button());
+    mousePressEvent (mouseEvent);
 }
 
 void KGrView::mouseReleaseEvent (QMouseEvent * mouseEvent)
 {
+    if (m_seeking) {
+        m_seeking = false;
+        return;
+    }
     Q_EMIT mouseLetGo (mouseEvent->button());
 }
 
@@ -29,14 +29,21 @@ Q_SIGNALS:
     void mouseClick (int);
     void mouseLetGo (int);
 
+    /*
+     * The timeline of a replay has been clicked or dragged to a tick.
+     */
+    void seekReplay (int);
+
 protected:
     void resizeEvent           (QResizeEvent   *) override;
     void mousePressEvent       (QMouseEvent * mouseEvent) override;
     void mouseDoubleClickEvent (QMouseEvent * mouseEvent) override;
     void mouseReleaseEvent     (QMouseEvent * mouseEvent) override;
+    void mouseMoveEvent        (QMouseEvent * mouseEvent) override;
 
 private:
     KGrScene    * m_scene;
+    bool          m_seeking;	// True while the timeline is being dragged.
 };
 
 #endif // KGRVIEW_H
@@ -0,0 +1,57 @@
+/*
+    SPDX-FileCopyrightText: 2026 The KGoldrunner Developers
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#ifndef KGRZOBRIST_H
+#define KGRZOBRIST_H
+
+#include <QtGlobal>
+
+/**
+ * The KGrZobrist class makes the keys of a Zobrist hash of the state of a
+ * level.  Each item of the state (a cell and its type, a runner and its
+ * position, a dug brick and its countdown, etc.) has a 64-bit key and the
+ * hash of the state is all the keys XORed together.  When an item changes,
+ * the hash is brought up to date by XORing out the old key and XORing in the
+ * new one, which takes the same short time however large the level is.
+ *
+ * Instead of a table of random keys for every value of every item, each key
+ * is made when needed by mixing the kind of item and its values with the
+ * SplitMix64 function (see KGrRandom), which gives keys just as random.
+ *
+ * @short   KGoldrunner State-Hash Keys
+ */
+
+class KGrZobrist
+{
+public:
+    /// The kinds of item in the state of a level.
+    enum Kind {Cell, RunnerPosition, RunnerDirection, DugBrick, Nuggets};
+
+    /**
+     * Return the key for an item of the state.
+     *
+     * @param kind   The kind of item.
+     * @param a      The item (e.g. the position of a cell) or its value.
+     * @param b      A value of the item (e.g. the type of a cell), if any.
+     * @param c      Another value of the item, if any.
+     */
+    static inline quint64 key (const Kind kind, const int a,
+                               const int b = 0, const int c = 0) {
+        quint64 h = mix (Q_UINT64_C(0x9e3779b97f4a7c15) * (kind + 1) +
+                         (quint32) a);
+        h = mix (h + (quint32) b);
+        return mix (h + (quint32) c);
+    }
+
+private:
+    static inline quint64 mix (quint64 z) {
+        z = (z ^ (z >> 30)) * Q_UINT64_C(0xbf58476d1ce4e5b9);
+        z = (z ^ (z >> 27)) * Q_UINT64_C(0x94d049bb133111eb);
+        return z ^ (z >> 31);
+    }
+};
+
+#endif // KGRZOBRIST_H